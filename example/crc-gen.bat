@@ -1,2 +1,2 @@
-..\build\crc-gen.exe verilog 8 16 1021 >> crc8_16_1201.v
-..\build\crc-gen.exe vhdl 8 16 1021 >> crc8_16_1201.vhd
\ No newline at end of file
+..\build\crc-gen.exe -o crc8_16_1201.v verilog 8 16 1021
+..\build\crc-gen.exe -o crc8_16_1201.vhd vhdl 8 16 1021
\ No newline at end of file
@@ -0,0 +1,476 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "crc-gen.h"
+#include "emit.h"
+#include "gf2.h"
+#include "parallel.h"
+
+//
+// crc-bench: times the two matrix builders and the HDL printer over a grid of
+// data and polynomial widths, with the peak RSS of every point, and writes the
+// results as CSV and JSON so runs of different commits can be compared.
+//
+
+struct bench_point
+{
+    int data_width;
+    int poly_width;
+    double serial_build_s;
+    double fast_build_s; // chain and matrix
+    double emit_s;
+    size_t emit_bytes;
+    long peak_rss_kb;
+};
+
+// a real polynomial for the common widths, x^N+x+1 otherwise
+static const char *bench_poly(int poly_width)
+{
+    switch (poly_width)
+    {
+    case 5:
+        return "05";
+    case 8:
+        return "07";
+    case 16:
+        return "1021";
+    case 32:
+        return "04C11DB7";
+    case 64:
+        return "42F0E1EBA9EA3693";
+    default:
+        return "3";
+    }
+}
+
+static void print_bench_usage()
+{
+    fprintf(stderr, "%s",
+            "\nusage: \n\tcrc-bench [options]"
+            "\n\noptions:"
+            "\n\t--data list     : data widths, comma separated (default 8,16,32,...,16384)"
+            "\n\t--poly list     : polynomial widths, comma separated (default 5,16,32,64)"
+            "\n\t--repeat R      : runs per point, the fastest is kept (default 3)"
+            "\n\t--lang verilog|vhdl : printer to time (default verilog)"
+            "\n\t--csv file      : write the results as CSV to file instead of stdout"
+            "\n\t--json file     : also write the results as JSON"
+            "\n\t-j N            : threads of the serial builder, 0 = all cores (default 1)"
+            "\n\n");
+}
+
+static bool parse_width_list(const char *s, int max, std::vector<int> *list)
+{
+    list->clear();
+
+    while (*s)
+    {
+        char *end;
+        long v = strtol(s, &end, 10);
+
+        if (end == s || v < 1 || v > max || (*end && *end != ','))
+            return false;
+
+        list->push_back((int)v);
+        s = *end ? end + 1 : end;
+    }
+
+    return !list->empty();
+}
+
+//
+// peak resident set size. linux can reset the high water mark, so each point
+// gets its own peak; elsewhere it is the peak of the process so far.
+//
+static void peak_rss_reset()
+{
+#if defined(__linux__)
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+
+    if (fp)
+    {
+        fputs("5", fp);
+        fclose(fp);
+    }
+#endif
+}
+
+static long peak_rss_kb()
+{
+#if defined(__linux__)
+    FILE *fp = fopen("/proc/self/status", "r");
+    char line[256];
+    long kb = -1;
+
+    if (!fp)
+        return -1;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (!strncmp(line, "VmHWM:", 6))
+            kb = atol(line + 6);
+    }
+
+    fclose(fp);
+
+    return kb;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return -1;
+
+    return (long)(pmc.PeakWorkingSetSize / 1024);
+#else
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru))
+        return -1;
+
+    return (long)ru.ru_maxrss;
+#endif
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void alloc_or_die(gf2_matrix *m, int rows, int cols)
+{
+    if (!gf2_matrix_alloc(m, rows, cols))
+    {
+        fprintf(stderr, "\n\terror: failed mem allocation\n");
+        exit(1);
+    }
+}
+
+//
+// one grid point: both builders, which must agree, then the printer writing
+// to the null device so only the formatting is timed
+//
+static bool bench_one(bench_point *pt, bool is_vhdl, int repeat, int num_threads)
+{
+    int N = pt->poly_width;
+    int M = pt->data_width;
+    std::vector<gf2_word> lfsr_poly(GF2_WORDS(N));
+    gf2_matrix serial;
+    gf2_matrix fast;
+    gf2_matrix chain;
+
+    parse_poly_string(bench_poly(N), N, &lfsr_poly[0]);
+
+    peak_rss_reset();
+
+    pt->serial_build_s = 1e30;
+    pt->fast_build_s = 1e30;
+    pt->emit_s = 1e30;
+
+    for (int r = 0; r < repeat; r++)
+    {
+        alloc_or_die(&serial, N, N + M);
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+        build_crc_matrix(N, &lfsr_poly[0], M, &serial, num_threads);
+
+        double t = seconds_since(t0);
+
+        if (t < pt->serial_build_s)
+            pt->serial_build_s = t;
+
+        if (r + 1 < repeat)
+            gf2_matrix_free(&serial);
+    }
+
+    for (int r = 0; r < repeat; r++)
+    {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+        alloc_or_die(&chain, M, N);
+        alloc_or_die(&fast, N, N + M);
+        build_crc_chain(N, &lfsr_poly[0], &chain);
+
+        if (!build_crc_matrix_fast(N, &lfsr_poly[0], M, &fast, 0, &chain))
+        {
+            fprintf(stderr, "\n\terror: failed mem allocation\n");
+            exit(1);
+        }
+
+        gf2_matrix_free(&chain);
+
+        double t = seconds_since(t0);
+
+        if (t < pt->fast_build_s)
+            pt->fast_build_s = t;
+
+        if (r + 1 < repeat)
+            gf2_matrix_free(&fast);
+    }
+
+    bool same = !memcmp(serial.bits, fast.bits, sizeof(gf2_word) * (size_t)serial.rows * serial.words);
+
+    gf2_matrix_free(&serial);
+
+    if (!same)
+    {
+        fprintf(stderr, "\n\terror: serial and fast matrix differ for data_width %d poly_width %d\n", M, N);
+        gf2_matrix_free(&fast);
+        return false;
+    }
+
+    crc_equations lfsr_eq;
+
+    lfsr_eq.lfsr_poly_size = N;
+    lfsr_eq.num_data_bits = M;
+    lfsr_eq.lfsr_poly = &lfsr_poly[0];
+    lfsr_eq.streaming = false;
+    lfsr_eq.first_row = 0;
+    lfsr_eq.rows = fast;
+    lfsr_eq.num_shared = 0;
+    lfsr_eq.shared_pairs = NULL;
+    lfsr_eq.pipeline = NULL;
+    lfsr_eq.num_keep_sets = 0;
+    lfsr_eq.keep_rows = NULL;
+    lfsr_eq.lanes = NULL;
+    lfsr_eq.fold = 1;
+    lfsr_eq.lut6 = NULL;
+
+#if defined(_WIN32)
+    FILE *null_sink = fopen("NUL", "wb");
+#else
+    FILE *null_sink = fopen("/dev/null", "wb");
+#endif
+
+    if (!null_sink)
+    {
+        fprintf(stderr, "\n\terror: cannot open the null device\n");
+        gf2_matrix_free(&fast);
+        return false;
+    }
+
+    for (int r = 0; r < repeat; r++)
+    {
+        emit_buf out;
+
+        if (!emit_open(&out, NULL, (size_t)1 << 20))
+        {
+            fprintf(stderr, "\n\terror: failed mem allocation\n");
+            exit(1);
+        }
+
+        out.sink = null_sink;
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+        if (is_vhdl)
+            print_vhdl_crc(&out, N, M, &lfsr_poly[0], &lfsr_eq);
+        else
+            print_verilog_crc(&out, N, M, &lfsr_poly[0], &lfsr_eq);
+
+        emit_close(&out);
+
+        double t = seconds_since(t0);
+
+        if (t < pt->emit_s)
+            pt->emit_s = t;
+
+        pt->emit_bytes = out.bytes;
+    }
+
+    fclose(null_sink);
+    gf2_matrix_free(&fast);
+
+    pt->peak_rss_kb = peak_rss_kb();
+
+    return true;
+} // bench_one
+
+static void write_csv(FILE *fp, const std::vector<bench_point> &points)
+{
+    fprintf(fp, "data_width,poly_width,serial_build_s,fast_build_s,emit_s,emit_bytes,peak_rss_kb\n");
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const bench_point *pt = &points[i];
+
+        fprintf(fp, "%d,%d,%.6f,%.6f,%.6f,%llu,%ld\n",
+                pt->data_width,
+                pt->poly_width,
+                pt->serial_build_s,
+                pt->fast_build_s,
+                pt->emit_s,
+                (unsigned long long)pt->emit_bytes,
+                pt->peak_rss_kb);
+    }
+}
+
+static void write_json(FILE *fp, const std::vector<bench_point> &points, const char *lang, int repeat, int num_threads)
+{
+    fprintf(fp, "{\n  \"lang\": \"%s\",\n  \"repeat\": %d,\n  \"threads\": %d,\n  \"results\": [\n", lang, repeat, num_threads);
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const bench_point *pt = &points[i];
+
+        fprintf(fp, "    {\"data_width\": %d, \"poly_width\": %d, \"serial_build_s\": %.6f, \"fast_build_s\": %.6f, "
+                    "\"emit_s\": %.6f, \"emit_bytes\": %llu, \"peak_rss_kb\": %ld}%s\n",
+                pt->data_width,
+                pt->poly_width,
+                pt->serial_build_s,
+                pt->fast_build_s,
+                pt->emit_s,
+                (unsigned long long)pt->emit_bytes,
+                pt->peak_rss_kb,
+                i + 1 < points.size() ? "," : "");
+    }
+
+    fprintf(fp, "  ]\n}\n");
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<int> data_widths;
+    std::vector<int> poly_widths;
+    int repeat = 3;
+    int num_threads = 1;
+    const char *lang = "verilog";
+    const char *csv_path = NULL;
+    const char *json_path = NULL;
+
+    for (int w = 8; w <= 16384; w *= 2)
+        data_widths.push_back(w);
+
+    poly_widths.push_back(5);
+    poly_widths.push_back(16);
+    poly_widths.push_back(32);
+    poly_widths.push_back(64);
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+        bool ok = val != NULL;
+
+        if (!strcmp(argv[i], "--data"))
+            ok = ok && parse_width_list(val, 65536, &data_widths);
+        else if (!strcmp(argv[i], "--poly"))
+            ok = ok && parse_width_list(val, 65536, &poly_widths);
+        else if (!strcmp(argv[i], "--repeat"))
+            ok = ok && (repeat = atoi(val)) >= 1;
+        else if (!strcmp(argv[i], "--lang"))
+            ok = ok && (!strcmp(lang = val, "verilog") || !strcmp(val, "vhdl"));
+        else if (!strcmp(argv[i], "--csv"))
+            csv_path = val;
+        else if (!strcmp(argv[i], "--json"))
+            json_path = val;
+        else if (!strcmp(argv[i], "-j"))
+            ok = ok && val[0] >= '0' && val[0] <= '9' && (num_threads = atoi(val)) >= 0;
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            print_bench_usage();
+            exit(1);
+        }
+
+        i++;
+    }
+
+    if (num_threads == 0)
+        num_threads = parallel_default_threads();
+
+    std::vector<bench_point> points;
+
+    for (size_t p = 0; p < poly_widths.size(); p++)
+    {
+        for (size_t d = 0; d < data_widths.size(); d++)
+        {
+            bench_point pt;
+
+            pt.data_width = data_widths[d];
+            pt.poly_width = poly_widths[p];
+
+            if (!bench_one(&pt, !strcmp(lang, "vhdl"), repeat, num_threads))
+                return 1;
+
+            fprintf(stderr, "data %5d poly %3d: serial %9.4f s, fast %9.4f s, emit %9.4f s (%llu bytes), peak rss %ld KB\n",
+                    pt.data_width,
+                    pt.poly_width,
+                    pt.serial_build_s,
+                    pt.fast_build_s,
+                    pt.emit_s,
+                    (unsigned long long)pt.emit_bytes,
+                    pt.peak_rss_kb);
+
+            points.push_back(pt);
+        }
+    }
+
+    FILE *fp = csv_path ? fopen(csv_path, "w") : stdout;
+
+    if (!fp)
+    {
+        fprintf(stderr, "\n\terror: cannot open output file %s\n", csv_path);
+        return 1;
+    }
+
+    write_csv(fp, points);
+
+    if (csv_path)
+        fclose(fp);
+
+    if (json_path)
+    {
+        fp = fopen(json_path, "w");
+
+        if (!fp)
+        {
+            fprintf(stderr, "\n\terror: cannot open output file %s\n", json_path);
+            return 1;
+        }
+
+        write_json(fp, points, lang, repeat, num_threads);
+        fclose(fp);
+    }
+
+    return 0;
+}
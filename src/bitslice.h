@@ -0,0 +1,123 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BITSLICE_H
+#define BITSLICE_H
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "gf2.h"
+
+//
+// bit-sliced signals: a lane holds one signal for SLICE_VECTORS independent
+// test vectors, bit t of the lane is its value in vector t, so a single XOR
+// works on all of them at once.
+//
+#define SLICE_WORDS 4
+#define SLICE_VECTORS (SLICE_WORDS * GF2_WORD_BITS)
+
+struct slice_lane
+{
+    gf2_word w[SLICE_WORDS];
+};
+
+static inline void lane_xor(slice_lane *dst, const slice_lane *src)
+{
+    for (int l = 0; l < SLICE_WORDS; l++)
+        dst->w[l] ^= src->w[l];
+}
+
+static inline bool lane_bit(const slice_lane *v, int t)
+{
+    return (v->w[t / GF2_WORD_BITS] >> (t % GF2_WORD_BITS)) & 1;
+}
+
+static inline uint64_t splitmix64(uint64_t *s)
+{
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ull);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+    return z ^ (z >> 31);
+}
+
+static inline void lane_random(slice_lane *v, uint64_t *s)
+{
+    for (int l = 0; l < SLICE_WORDS; l++)
+        v->w[l] = splitmix64(s);
+}
+
+//
+// the serial LFSR of lfsr_serial_shift_crc on SLICE_VECTORS vectors. the
+// state is a ring: bit n lives at ring[(head + n) % N], so a shift moves head
+// and costs one XOR per feedback tap instead of N moves.
+//
+struct sliced_lfsr
+{
+    int N;
+    int head;
+    std::vector<int> taps; // set bits of the polynomial above bit 0
+    std::vector<slice_lane> ring;
+};
+
+static inline void sliced_lfsr_init(sliced_lfsr *r, int lfsr_poly_size, const gf2_word *lfsr_poly)
+{
+    r->N = lfsr_poly_size;
+    r->head = 0;
+    r->taps.clear();
+    r->ring.assign(lfsr_poly_size, slice_lane());
+
+    for (int n = 1; n < lfsr_poly_size; n++)
+    {
+        if (gf2_get(lfsr_poly, n))
+            r->taps.push_back(n);
+    }
+}
+
+static inline slice_lane *sliced_lfsr_bit(sliced_lfsr *r, int n)
+{
+    return &r->ring[(r->head + n) % r->N];
+}
+
+// one shift with data bit d, f = poly|1 as in lfsr_serial_shift_crc
+static inline void sliced_lfsr_shift(sliced_lfsr *r, const slice_lane *d)
+{
+    slice_lane fb = *sliced_lfsr_bit(r, r->N - 1);
+
+    lane_xor(&fb, d);
+    r->head = (r->head + r->N - 1) % r->N;
+    r->ring[r->head] = fb;
+
+    for (size_t j = 0; j < r->taps.size(); j++)
+        lane_xor(sliced_lfsr_bit(r, r->taps[j]), &fb);
+}
+
+#endif // BITSLICE_H
@@ -0,0 +1,309 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "channels.h"
+
+int channel_id_bits(int channels)
+{
+    int bits = 1;
+
+    while ((1 << bits) < channels)
+        bits++;
+
+    return bits;
+}
+
+static const char *channel_ram_style(int channels)
+{
+    return channels > CRC_CHANNELS_DISTRIBUTED ? "block" : "distributed";
+}
+
+void report_channels(FILE *fp, const char *name, int N, int channels)
+{
+    fprintf(fp, "%s: %d channels: %d x %d bit state in %s ram, %d bit channel_id, crc_out 2 clocks after crc_en\n",
+            name, channels, channels, N, channel_ram_style(channels), channel_id_bits(channels));
+}
+
+// "1+x^a+...+x^N"
+static void emit_channels_poly(emit_buf *out, int lfsr_poly_size, const gf2_word *lfsr_poly)
+{
+    for (int l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), 0); l >= 0; l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), l + 1))
+    {
+        if (l)
+            emit_fmt(out, "+x^%d", l);
+        else
+            EMIT_LIT(out, "1");
+    }
+
+    emit_fmt(out, "+x^%d", lfsr_poly_size);
+}
+
+void print_verilog_crc_channels(emit_buf *out,
+                                int lfsr_poly_size,
+                                int num_data_bits,
+                                const gf2_word *lfsr_poly,
+                                crc_equations *lfsr_eq,
+                                int channels)
+{
+    EMIT_LIT(out, "\n//-----------------------------------------------------------------------------\n");
+    emit_fmt(out, "// %d channel CRC module for\n", channels);
+    emit_fmt(out, "//    data[%d:0]\n", num_data_bits - 1);
+    emit_fmt(out, "//    crc[%d:0]=", lfsr_poly_size - 1);
+    emit_channels_poly(out, lfsr_poly_size, lfsr_poly);
+    EMIT_LIT(out, ";\n");
+    EMIT_LIT(out, "// every beat continues the CRC of its channel_id, crc_sop starts it from INIT.\n");
+    EMIT_LIT(out, "// crc_out is the CRC of crc_channel after the beat, valid with crc_valid two\n");
+    EMIT_LIT(out, "// clocks after crc_en. a beat can come on every clock, of any channel.\n");
+    EMIT_LIT(out, "// channel_id is only read with crc_en and must then be below CHANNELS.\n");
+    EMIT_LIT(out, "//-----------------------------------------------------------------------------\n\n");
+
+    EMIT_LIT(out, "module crc_channels #(\n");
+    emit_fmt(out, "    parameter INPUT_WIDTH  = %d,\n", num_data_bits);
+    emit_fmt(out, "    parameter OUTPUT_WIDTH = %d,\n", lfsr_poly_size);
+    emit_fmt(out, "    parameter INIT         = {%d{1'b1}},\n", lfsr_poly_size);
+    emit_fmt(out, "    parameter OUTPUT_XOR   = {%d{1'b0}},\n", lfsr_poly_size);
+    EMIT_LIT(out, "    parameter INPUT_INV    = 1'b0,\n");
+    EMIT_LIT(out, "    parameter OUTPUT_INV   = 1'b0,\n");
+    emit_fmt(out, "    parameter CHANNELS     = %d,\n", channels);
+    emit_fmt(out, "    parameter CHANNEL_BITS = %d\n", channel_id_bits(channels));
+    EMIT_LIT(out, ") (\n");
+    EMIT_LIT(out, "    input  wire [ (INPUT_WIDTH-1):0] data_in,\n");
+    EMIT_LIT(out, "    input  wire                      crc_en,\n");
+    EMIT_LIT(out, "    input  wire                      crc_sop,\n");
+    EMIT_LIT(out, "    input  wire [(CHANNEL_BITS-1):0] channel_id,\n");
+    EMIT_LIT(out, "    output wire [(OUTPUT_WIDTH-1):0] crc_out,\n");
+    EMIT_LIT(out, "    output reg                       crc_valid,\n");
+    EMIT_LIT(out, "    output reg  [(CHANNEL_BITS-1):0] crc_channel,\n");
+    EMIT_LIT(out, "    input  wire                      rst,\n");
+    EMIT_LIT(out, "    input  wire                      clk\n");
+    EMIT_LIT(out, ");\n\n");
+
+    EMIT_LIT(out, "    genvar ii;\n");
+    EMIT_LIT(out, "    wire [ (INPUT_WIDTH-1):0] data_in_inv;\n");
+    EMIT_LIT(out, "    wire [ (INPUT_WIDTH-1):0] data_in_inv_res;\n");
+    EMIT_LIT(out, "    wire [(OUTPUT_WIDTH-1):0] crc_out_inv;\n");
+    EMIT_LIT(out, "    wire [(OUTPUT_WIDTH-1):0] crc_out_inv_res;\n");
+    EMIT_LIT(out, "    wire [(OUTPUT_WIDTH-1):0] lfsr_q;\n");
+    EMIT_LIT(out, "    reg  [(OUTPUT_WIDTH-1):0] lfsr_c;\n\n");
+
+    EMIT_LIT(out, "    // per channel lfsr_q, read a clock ahead of its beat\n");
+    emit_fmt(out, "    (* ram_style = \"%s\" *)\n", channel_ram_style(channels));
+    EMIT_LIT(out, "    reg  [(OUTPUT_WIDTH-1):0] state_ram [0:(CHANNELS-1)];\n");
+    EMIT_LIT(out, "    reg  [(OUTPUT_WIDTH-1):0] ram_q;\n");
+    EMIT_LIT(out, "    reg  [ (INPUT_WIDTH-1):0] data_q;\n");
+    EMIT_LIT(out, "    reg  [(CHANNEL_BITS-1):0] channel_q;\n");
+    EMIT_LIT(out, "    reg                       crc_en_q;\n");
+    EMIT_LIT(out, "    reg                       crc_sop_q;\n");
+    EMIT_LIT(out, "    reg  [(OUTPUT_WIDTH-1):0] crc_q;\n");
+    EMIT_LIT(out, "    wire                      forward;\n\n");
+
+    EMIT_LIT(out, "    generate\n");
+    EMIT_LIT(out, "        for (ii = 0; ii < INPUT_WIDTH; ii = ii + 1) begin\n");
+    EMIT_LIT(out, "            assign data_in_inv[ii] = data_q[INPUT_WIDTH-ii-1];\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "        for (ii = 0; ii < OUTPUT_WIDTH; ii = ii + 1) begin\n");
+    EMIT_LIT(out, "            assign crc_out_inv[ii] = crc_q[OUTPUT_WIDTH-ii-1];\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "    endgenerate\n\n");
+
+    EMIT_LIT(out, "    // input reverse\n");
+    EMIT_LIT(out, "    assign data_in_inv_res = (INPUT_INV == 1'b1) ? (data_in_inv) : data_q;\n");
+    EMIT_LIT(out, "    // output reverse\n");
+    EMIT_LIT(out, "    assign crc_out_inv_res = (OUTPUT_INV == 1'b1) ? (crc_out_inv) : crc_q;\n");
+    EMIT_LIT(out, "    // output xor\n");
+    EMIT_LIT(out, "    assign crc_out         = crc_out_inv_res ^ OUTPUT_XOR;\n\n");
+
+    EMIT_LIT(out, "    // the last beat is written back on the clock this one was read, a beat of\n");
+    EMIT_LIT(out, "    // the same channel takes its state from crc_q\n");
+    EMIT_LIT(out, "    assign forward = crc_valid && (crc_channel == channel_q);\n");
+    EMIT_LIT(out, "    assign lfsr_q  = crc_sop_q ? INIT : forward ? crc_q : ram_q;\n\n");
+
+    EMIT_LIT(out, "    always @(*) begin");
+    emit_equations(out, lfsr_eq, NULL, 0, "lfsr_c", false);
+    EMIT_LIT(out, "\n    end // always\n\n");
+
+    EMIT_LIT(out, "    always @(posedge clk) begin\n");
+    EMIT_LIT(out, "        if (crc_en)\n");
+    EMIT_LIT(out, "            ram_q <= state_ram[channel_id];\n");
+    EMIT_LIT(out, "        if (crc_en_q)\n");
+    EMIT_LIT(out, "            state_ram[channel_q] <= lfsr_c;\n");
+    EMIT_LIT(out, "    end // always\n\n");
+
+    EMIT_LIT(out, "    always @(posedge clk) begin\n");
+    EMIT_LIT(out, "        data_q    <= data_in;\n");
+    EMIT_LIT(out, "        channel_q <= channel_id;\n");
+    EMIT_LIT(out, "        crc_sop_q <= crc_sop;\n");
+    EMIT_LIT(out, "        if (crc_en_q) begin\n");
+    EMIT_LIT(out, "            crc_q       <= lfsr_c;\n");
+    EMIT_LIT(out, "            crc_channel <= channel_q;\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "    end // always\n\n");
+
+    EMIT_LIT(out, "    always @(posedge clk, posedge rst) begin\n");
+    EMIT_LIT(out, "        if (rst) begin\n");
+    EMIT_LIT(out, "            crc_en_q  <= 1'b0;\n");
+    EMIT_LIT(out, "            crc_valid <= 1'b0;\n");
+    EMIT_LIT(out, "        end else begin\n");
+    EMIT_LIT(out, "            crc_en_q  <= crc_en;\n");
+    EMIT_LIT(out, "            crc_valid <= crc_en_q;\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "    end // always\n");
+    EMIT_LIT(out, "endmodule // crc_channels\n\n");
+
+} // print_verilog_crc_channels
+
+void print_vhdl_crc_channels(emit_buf *out,
+                             int lfsr_poly_size,
+                             int num_data_bits,
+                             const gf2_word *lfsr_poly,
+                             crc_equations *lfsr_eq,
+                             int channels)
+{
+    EMIT_LIT(out, "\n-------------------------------------------------------------------------------\n");
+    emit_fmt(out, "-- %d channel CRC module for\n", channels);
+    emit_fmt(out, "--    data(%d downto 0)\n", num_data_bits - 1);
+    emit_fmt(out, "--    crc(%d downto 0)=", lfsr_poly_size - 1);
+    emit_channels_poly(out, lfsr_poly_size, lfsr_poly);
+    EMIT_LIT(out, ";\n");
+    EMIT_LIT(out, "-- every beat continues the CRC of its channel_id, crc_sop starts it from INIT.\n");
+    EMIT_LIT(out, "-- crc_out is the CRC of crc_channel after the beat, valid with crc_valid two\n");
+    EMIT_LIT(out, "-- clocks after crc_en. a beat can come on every clock, of any channel.\n");
+    EMIT_LIT(out, "-- channel_id is only read with crc_en and must then be below CHANNELS.\n");
+    EMIT_LIT(out, "-------------------------------------------------------------------------------\n");
+
+    EMIT_LIT(out, "library ieee;\n");
+    EMIT_LIT(out, "use ieee.std_logic_1164.all;\n");
+    EMIT_LIT(out, "use ieee.numeric_std.all;\n\n");
+
+    EMIT_LIT(out, "entity crc_channels is\n");
+    EMIT_LIT(out, "    generic (\n");
+    emit_fmt(out, "        INPUT_WIDTH  : integer := %d;\n", num_data_bits);
+    emit_fmt(out, "        OUTPUT_WIDTH : integer := %d;\n", lfsr_poly_size);
+    emit_fmt(out, "        INIT         : std_logic_vector(%d downto 0) := (others => '1');\n", lfsr_poly_size - 1);
+    emit_fmt(out, "        OUTPUT_XOR   : std_logic_vector(%d downto 0) := (others => '0');\n", lfsr_poly_size - 1);
+    EMIT_LIT(out, "        INPUT_INV    : std_logic := '0';\n");
+    EMIT_LIT(out, "        OUTPUT_INV   : std_logic := '0';\n");
+    emit_fmt(out, "        CHANNELS     : integer := %d;\n", channels);
+    emit_fmt(out, "        CHANNEL_BITS : integer := %d\n", channel_id_bits(channels));
+    EMIT_LIT(out, "    );\n");
+    EMIT_LIT(out, "    port (\n");
+    EMIT_LIT(out, "        data_in     : in  std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "        crc_en      : in  std_logic;\n");
+    EMIT_LIT(out, "        crc_sop     : in  std_logic;\n");
+    EMIT_LIT(out, "        channel_id  : in  std_logic_vector((CHANNEL_BITS-1) downto 0);\n");
+    EMIT_LIT(out, "        crc_out     : out std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "        crc_valid   : out std_logic;\n");
+    EMIT_LIT(out, "        crc_channel : out std_logic_vector((CHANNEL_BITS-1) downto 0);\n");
+    EMIT_LIT(out, "        rst         : in  std_logic;\n");
+    EMIT_LIT(out, "        clk         : in  std_logic\n");
+    EMIT_LIT(out, "    );\n");
+    EMIT_LIT(out, "end entity crc_channels;\n\n");
+
+    EMIT_LIT(out, "architecture imp_crc_channels of crc_channels is\n");
+    EMIT_LIT(out, "    type state_ram_t is array (0 to CHANNELS-1) of std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n\n");
+    EMIT_LIT(out, "    signal data_in_inv      : std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal data_in_inv_res  : std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal crc_out_inv      : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal crc_out_inv_res  : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal lfsr_q           : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal lfsr_c           : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    -- per channel lfsr_q, read a clock ahead of its beat\n");
+    EMIT_LIT(out, "    signal state_ram        : state_ram_t;\n");
+    EMIT_LIT(out, "    attribute ram_style     : string;\n");
+    emit_fmt(out, "    attribute ram_style of state_ram : signal is \"%s\";\n", channel_ram_style(channels));
+    EMIT_LIT(out, "    signal ram_q            : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal data_q           : std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal channel_q        : std_logic_vector((CHANNEL_BITS-1) downto 0);\n");
+    EMIT_LIT(out, "    signal crc_en_q         : std_logic;\n");
+    EMIT_LIT(out, "    signal crc_sop_q        : std_logic;\n");
+    EMIT_LIT(out, "    signal crc_q            : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal crc_valid_i      : std_logic;\n");
+    EMIT_LIT(out, "    signal crc_channel_i    : std_logic_vector((CHANNEL_BITS-1) downto 0);\n");
+    EMIT_LIT(out, "    signal forward          : std_logic;\n");
+    EMIT_LIT(out, "begin\n\n");
+
+    EMIT_LIT(out, "    -- input reverse\n");
+    EMIT_LIT(out, "    gen_data_in_inv: for ii in 0 to INPUT_WIDTH-1 generate\n");
+    EMIT_LIT(out, "        data_in_inv(ii) <= data_q(INPUT_WIDTH-ii-1);\n");
+    EMIT_LIT(out, "    end generate gen_data_in_inv;\n\n");
+    EMIT_LIT(out, "    -- output reverse\n");
+    EMIT_LIT(out, "    gen_crc_out_inv: for ii in 0 to OUTPUT_WIDTH-1 generate\n");
+    EMIT_LIT(out, "        crc_out_inv(ii) <= crc_q(OUTPUT_WIDTH-ii-1);\n");
+    EMIT_LIT(out, "    end generate gen_crc_out_inv;\n\n");
+    EMIT_LIT(out, "    -- input reverse\n");
+    EMIT_LIT(out, "    data_in_inv_res <= data_in_inv when INPUT_INV = '1' else data_q;\n");
+    EMIT_LIT(out, "    -- output reverse\n");
+    EMIT_LIT(out, "    crc_out_inv_res <= crc_out_inv when OUTPUT_INV = '1' else crc_q;\n");
+    EMIT_LIT(out, "    -- output xor\n");
+    EMIT_LIT(out, "    crc_out <= crc_out_inv_res xor OUTPUT_XOR;\n");
+    EMIT_LIT(out, "    crc_valid <= crc_valid_i;\n");
+    EMIT_LIT(out, "    crc_channel <= crc_channel_i;\n\n");
+
+    EMIT_LIT(out, "    -- the last beat is written back on the clock this one was read, a beat of\n");
+    EMIT_LIT(out, "    -- the same channel takes its state from crc_q\n");
+    EMIT_LIT(out, "    forward <= '1' when crc_valid_i = '1' and crc_channel_i = channel_q else '0';\n");
+    EMIT_LIT(out, "    lfsr_q  <= INIT when crc_sop_q = '1' else crc_q when forward = '1' else ram_q;\n");
+
+    emit_equations(out, lfsr_eq, NULL, 0, "lfsr_c", true);
+    EMIT_LIT(out, "\n\n");
+
+    EMIT_LIT(out, "    process (clk) begin\n");
+    EMIT_LIT(out, "        if rising_edge(clk) then\n");
+    EMIT_LIT(out, "            if crc_en = '1' then\n");
+    EMIT_LIT(out, "                ram_q <= state_ram(to_integer(unsigned(channel_id)));\n");
+    EMIT_LIT(out, "            end if;\n");
+    EMIT_LIT(out, "            if crc_en_q = '1' then\n");
+    EMIT_LIT(out, "                state_ram(to_integer(unsigned(channel_q))) <= lfsr_c;\n");
+    EMIT_LIT(out, "            end if;\n");
+    EMIT_LIT(out, "        end if;\n");
+    EMIT_LIT(out, "    end process;\n\n");
+
+    EMIT_LIT(out, "    process (clk) begin\n");
+    EMIT_LIT(out, "        if rising_edge(clk) then\n");
+    EMIT_LIT(out, "            data_q    <= data_in;\n");
+    EMIT_LIT(out, "            channel_q <= channel_id;\n");
+    EMIT_LIT(out, "            crc_sop_q <= crc_sop;\n");
+    EMIT_LIT(out, "            if crc_en_q = '1' then\n");
+    EMIT_LIT(out, "                crc_q         <= lfsr_c;\n");
+    EMIT_LIT(out, "                crc_channel_i <= channel_q;\n");
+    EMIT_LIT(out, "            end if;\n");
+    EMIT_LIT(out, "        end if;\n");
+    EMIT_LIT(out, "    end process;\n\n");
+
+    EMIT_LIT(out, "    process (clk, rst) begin\n");
+    EMIT_LIT(out, "        if rst = '1' then\n");
+    EMIT_LIT(out, "            crc_en_q    <= '0';\n");
+    EMIT_LIT(out, "            crc_valid_i <= '0';\n");
+    EMIT_LIT(out, "        elsif rising_edge(clk) then\n");
+    EMIT_LIT(out, "            crc_en_q    <= crc_en;\n");
+    EMIT_LIT(out, "            crc_valid_i <= crc_en_q;\n");
+    EMIT_LIT(out, "        end if;\n");
+    EMIT_LIT(out, "    end process;\n\n");
+    EMIT_LIT(out, "end architecture imp_crc_channels;\n");
+
+} // print_vhdl_crc_channels
@@ -0,0 +1,74 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <stdio.h>
+
+#include "crc-gen.h"
+
+//
+// multi-channel CRC core, beats of many packets interleaved on one bus
+//
+// the lfsr_q of every channel lives in a RAM instead of a register. a beat
+// takes two clocks: on the first the RAM is read at channel_id, on the second
+// the equations run on that state (INIT on crc_sop) and the result is written
+// back and shown on crc_out. the read is gated with crc_en, so channel_id
+// only has to be in range with a beat. the write of a beat lands on the same clock as
+// the read of the next one, so when the next beat is of the same channel it
+// takes the state from the crc_out register instead of the RAM. that is the
+// only hazard, a new beat every clock on any mix of channels runs at full
+// rate.
+//
+#define CRC_CHANNELS_MAX 65536
+
+// RAMs of up to this many channels are asked for as distributed RAM
+#define CRC_CHANNELS_DISTRIBUTED 64
+
+// width of the channel_id port
+int channel_id_bits(int channels);
+
+// state RAM size and latency
+void report_channels(FILE *fp, const char *name, int N, int channels);
+
+void print_verilog_crc_channels(emit_buf *out,
+                                int lfsr_poly_size,
+                                int num_data_bits,
+                                const gf2_word *lfsr_poly,
+                                crc_equations *lfsr_eq,
+                                int channels);
+
+void print_vhdl_crc_channels(emit_buf *out,
+                             int lfsr_poly_size,
+                             int num_data_bits,
+                             const gf2_word *lfsr_poly,
+                             crc_equations *lfsr_eq,
+                             int channels);
+
+#endif // CHANNELS_H
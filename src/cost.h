@@ -0,0 +1,66 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef COST_H
+#define COST_H
+
+//
+// gate and level estimates of an n input XOR, shared by the reports
+//
+
+#define LUT6_INPUTS 6
+
+// XOR2 levels of a balanced tree over n inputs
+static inline int xor2_levels(int n)
+{
+    int levels = 0;
+
+    while ((1 << levels) < n)
+        levels++;
+
+    return levels;
+}
+
+// LUT6 of an n input XOR, the first takes 6 inputs and each next one 5 more
+static inline int lut6_count(int n)
+{
+    return n > 1 ? (n - 1 + LUT6_INPUTS - 2) / (LUT6_INPUTS - 1) : 0;
+}
+
+// LUT6 levels of a tree over n inputs
+static inline int lut6_levels(int n)
+{
+    int levels = 0;
+
+    for (long long reach = 1; reach < n; reach *= LUT6_INPUTS)
+        levels++;
+
+    return levels;
+}
+
+#endif // COST_H
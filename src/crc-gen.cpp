@@ -30,558 +30,1646 @@ THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdlib.h>
 #include <string.h>
 
-void print_verilog_crc(int lfsr_poly_size,
-                       int num_data_bits,
-                       unsigned int *lfsr_poly_array,
-                       unsigned int *lfsr_matrix);
-
-void print_vhdl_crc(int lfsr_poly_size,
-                    int num_data_bits,
-                    unsigned int *lfsr_poly_array,
-                    unsigned int *lfsr_matrix);
-
-void build_crc_matrix(int lfsr_poly_size,
-                      unsigned int *lfsr_poly_array,
-                      int num_data_bits,
-                      unsigned int *lfsr_matrix);
-
-void lfsr_serial_shift_crc(int num_bits_to_shift,
-                           int lfsr_poly_size,
-                           unsigned int *lfsr_poly,
-                           unsigned int *lfsr_cur,
-                           unsigned int *lfsr_next,
-                           int num_data_bits,
-                           unsigned int *data_cur);
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "crc-gen.h"
+#include "channels.h"
+#include "cse.h"
+#include "emit.h"
+#include "fold.h"
+#include "gf2.h"
+#include "hamming.h"
+#include "lanes.h"
+#include "matrix_cache.h"
+#include "matrix_lru.h"
+#include "parallel.h"
+#include "pipeline.h"
+#include "scrambler.h"
+#include "selfcheck.h"
+#include "server.h"
+#include "soft_crc.h"
+#include "stats.h"
+#include "testbench.h"
+
+//
+// one generation request, from the command line or from a line of a manifest
+//
+enum crc_language
+{
+    LANG_VERILOG,
+    LANG_VHDL,
+    LANG_C, // header for the software engine, see soft_crc.h
+};
+
+struct crc_job
+{
+    crc_language language;
+    int data_width;
+    int poly_width;
+    const char *poly_str;
+    const char *out_path; // NULL = stdout
+    FILE *out_file; // server: print here instead of out_path
+    bool use_serial_builder;
+    bool streaming;
+    bool use_cse;
+    int pipeline_stages; // 0 = single cycle
+    bool byte_enables;
+    int lanes; // 0 = flat equations
+    int fold; // clocks per data_in beat, 1 = fully parallel
+    bool lut6;
+    int channels; // 0 = a single lfsr_q register
+
+    // print a scrambler or descrambler on the LFSR instead of the CRC
+    scrambler_type scrambler;
+    bool descramble;
+    int num_threads;
+
+    // software engine: the INIT, OUTPUT_XOR, INPUT_INV and OUTPUT_INV values,
+    // hex strings NULL for the HDL defaults
+    const char *init_str;
+    const char *xorout_str;
+    bool input_inv;
+    bool output_inv;
+    bool throughput;
+
+    // check the equations against the serial LFSR before printing them
+    bool selfcheck;
+    long long vectors;
+
+    // write <out_path without extension>_tb.v|.vhd and _tb.mem next to it
+    bool testbench;
+
+    // --stats, NULL if not requested; reported on stderr, or as JSON to
+    // stats_json if that is set
+    crc_stats *stats;
+    const char *stats_json;
+
+    // directory of cached matrices, NULL = none; see matrix_cache.h
+    const char *cache_dir;
+    // write the flat matrix in the cache format to this file
+    const char *export_path;
+
+    // analyze: longest undetected errors counted, 0 = not given
+    int max_weight;
+
+    // server: matrices built by earlier requests, NULL = none
+    matrix_lru *lru;
+    // server: set to the reason of a failure for the reply, NULL = none
+    std::string *error;
+};
+
+// beats per selfcheck vector, the state carries over from beat to beat
+#define SELFCHECK_BEATS 4
 
 void print_usage()
 {
-    fprintf(stderr, "%s%s%s%s",
-            "\nusage: \n\tcrc-gen language data_width poly_width poly_string",
+    fprintf(stderr, "%s%s%s%s%s%s%s",
+            "\nusage: \n\tcrc-gen [options] language data_width poly_width poly_string"
+            "\n\tcrc-gen [options] --batch manifest"
+            "\n\tcrc-gen [-j N] [-o file] [--max-weight W] analyze data_len[,...] poly_width poly_string[,...]"
+            "\n\tcrc-gen [-j N] [--cache dir] [--lru-mb MB] --serve socket"
+            "\n\tcrc-gen --client socket [options] language data_width poly_width poly_string | stats | stop",
             "\n\nparameters:",
-            "\n\tlanguage    : verilog or vhdl"
-            "\n\tdata_width  : data bus width {1..1024}"
-            "\n\tpoly_width  : polynomial width {1..1024}"
+            "\n\tlanguage    : verilog, vhdl or c (software CRC header, poly_width {1..64})"
+            "\n\tdata_width  : data bus width {1..65536}"
+            "\n\tpoly_width  : polynomial width {1..65536}"
             "\n\tpoly_string : polynomial string in hex",
+            "\n\noptions:"
+            "\n\t--builder=serial|fast : matrix builder, serial LFSR simulation or algebraic (default fast)"
+            "\n\t-j N                  : build the serial matrix on N threads, 0 = all cores (default 1)"
+            "\n\t--stream              : compute and print the equations a few rows at a time,"
+            "\n\t                        memory O(N+M) bits instead of the full (N+M)xN matrix"
+            "\n\t-o file               : write to file instead of stdout, replaced atomically"
+            "\n\t--cse                 : extract XOR terms shared between the equations into named"
+            "\n\t                        signals, the XOR2 gate count is reported on stderr"
+            "\n\t--pipeline K          : compute the data terms in K register stages {1..16} ahead of"
+            "\n\t                        the lfsr_q feedback, adds a crc_valid output"
+            "\n\t--byte-enables        : add a data_keep input with one bit per byte, the last beat of"
+            "\n\t                        a packet may carry 1..data_width/8 bytes"
+            "\n\t--lanes L             : split data_in into L lanes with their own registered partial"
+            "\n\t                        CRC, merged with shift matrices a clock later, adds a crc_valid"
+            "\n\t                        output; the logic depth of both stages is reported"
+            "\n\t--fold F              : take each data_in beat over F clocks in data_width/F bit slices,"
+            "\n\t                        with a crc_ready output; area and throughput are reported"
+            "\n\t--lut6                : map the equations to 6-input XOR groups shared between them,"
+            "\n\t                        in depth-balanced trees; the LUTs and levels are reported"
+            "\n\t--channels C          : print a core for C {2..65536} interleaved channels, with a"
+            "\n\t                        channel_id and crc_sop input and the states in a RAM"
+            "\n\t--scrambler T         : print a data_width parallel scrambler on the LFSR instead,"
+            "\n\t                        T = additive or self-sync"
+            "\n\t--descrambler T       : the same for the descrambler"
+            "\n\t--init hex            : INIT of the software CRC and the testbench (default all ones)"
+            "\n\t--output-xor hex      : OUTPUT_XOR of the software CRC and the testbench (default 0)"
+            "\n\t--input-inv           : INPUT_INV = 1 for the software CRC and the testbench"
+            "\n\t--output-inv          : OUTPUT_INV = 1 for the software CRC and the testbench"
+            "\n\t--throughput          : report GB/s of the software CRC methods on stderr"
+            "\n\t--selfcheck           : simulate the equations against the serial LFSR before printing,"
+            "\n\t                        fails with the first differing bit"
+            "\n\t--testbench           : with -o, also write a self-checking testbench <file>_tb.v or .vhd"
+            "\n\t                        and its golden vectors <file>_tb.mem"
+            "\n\t--vectors N           : random vectors for --selfcheck, clock cycles for --testbench"
+            "\n\t                        (default 1048576)"
+            "\n\t--stats               : report phase timings, equation fan-in, data fanout and a LUT6"
+            "\n\t                        estimate on stderr"
+            "\n\t--stats-json file     : write the --stats report as JSON to file instead"
+            "\n\t--cache dir           : reuse matrices from dir and store new ones there"
+            "\n\t                        (default $CRC_GEN_CACHE if set)"
+            "\n\t--export-matrix file  : write the matrix in the binary cache format to file"
+            "\n\t--max-weight W        : analyze: count undetected errors of up to W bits {2..4} (default 4)",
+            "\n\nbatch mode:"
+            "\n\tevery manifest line is 'language data_width poly_width poly_string output_file',"
+            "\n\tempty lines and lines starting with # are skipped. all modules are generated"
+            "\n\tby one process on -j threads, jobs with the same polynomial share the build.",
+            "\n\nanalyze mode:"
+            "\n\tHamming distance and undetected error counts of each polynomial (poly_width {1..64})"
+            "\n\tat each data length in bits, ranked best first on all cores unless -j is given."
+            "\n\tthe last line is the best poly_string."
+            "\n\nserver mode:"
+            "\n\t--serve listens on a Unix domain socket and generates on -j threads (default all"
+            "\n\tcores), keeping the last --lru-mb MB of matrices in memory (default 256). --client"
+            "\n\tsends its arguments there and writes the module to -o or stdout; --stream, --cse,"
+            "\n\t--pipeline, --byte-enables, --lanes, --fold, --lut6, --channels, --scrambler, --builder"
+            "\n\tand the c target options are served. 'stats' reports requests/s and the cache hit rate, 'stop' ends"
+            "\n\tthe server.",
             "\n\nexample: usb crc5 = x^5+x^2+1"
             "\n\tcrc-gen verilog 8 5 05\n\n");
 }
 
-int main(int argc, char *argv[])
+// default size of the --serve matrix cache
+const int SERVER_LRU_MB = 256;
+
+// the full bit-packed matrix takes N*(N+M)/8 bytes, 1 GB at the MAX values;
+// with --stream only a window of the equations is kept in memory
+const int DATA_WIDTH_MAX = 65536;
+const int POLY_WIDTH_MAX = 65536;
+
+//
+// fill in language and widths from the positional parameters,
+// returns the error message or NULL if they are valid
+//
+const char *parse_crc_params(crc_job *job,
+                             const char *language,
+                             const char *data_width,
+                             const char *poly_width,
+                             const char *poly_str)
+{
+    if (!strcmp(language, "verilog"))
+        job->language = LANG_VERILOG;
+    else if (!strcmp(language, "vhdl"))
+        job->language = LANG_VHDL;
+    else if (!strcmp(language, "c"))
+        job->language = LANG_C;
+    else
+        return "invalid language";
+
+    job->data_width = atoi(data_width);
+
+    if (job->data_width < 1 || job->data_width > DATA_WIDTH_MAX)
+        return "invalid data_width";
+
+    job->poly_width = atoi(poly_width);
+
+    if (job->poly_width < 1 || job->poly_width > POLY_WIDTH_MAX)
+        return "invalid poly_width";
+
+    job->poly_str = poly_str;
+
+    if ((int)strlen(poly_str) < (job->poly_width + 3) / 4)
+        return "invalid poly string";
+
+    if (job->byte_enables && job->data_width % 8)
+        return "data_width must be a multiple of 8 with --byte-enables";
+
+    if (job->lanes && (job->lanes > job->data_width || job->data_width % job->lanes))
+        return "data_width must be a multiple of --lanes";
+
+    if (job->fold > job->data_width || job->data_width % job->fold)
+        return "data_width must be a multiple of --fold";
+
+    if (job->language == LANG_C && (job->streaming || job->use_cse || job->pipeline_stages || job->byte_enables || job->lanes || job->fold > 1 || job->lut6 ||
+                                    job->channels || job->selfcheck || job->testbench || job->stats))
+        return "--stream, --cse, --pipeline, --byte-enables, --lanes, --fold, --lut6, --channels, --selfcheck, --testbench and --stats do not apply to the c target";
+
+    if (job->scrambler && job->language == LANG_C)
+        return "--scrambler and --descrambler need verilog or vhdl";
+
+    if ((job->language == LANG_C || job->throughput) && job->poly_width > SOFT_CRC_WIDTH_MAX)
+        return "poly_width must be 1..64 for the software engine";
+
+    // NUM_VECTORS is an integer parameter of the testbench
+    if (job->testbench && job->vectors > 0x7fffffff)
+        return "--vectors must be below 2^31 with --testbench";
+
+    if (job->selfcheck && job->vectors > selfcheck_max_vectors(SELFCHECK_BEATS))
+        return "--vectors must be at most 2^41 - 1024 with --selfcheck";
+
+    std::vector<gf2_word> value(GF2_WORDS(job->poly_width));
+
+    if (job->init_str && !parse_poly_string(job->init_str, job->poly_width, &value[0]))
+        return "invalid init string";
+
+    if (job->xorout_str && !parse_poly_string(job->xorout_str, job->poly_width, &value[0]))
+        return "invalid output xor string";
+
+    return NULL;
+}
+
+
+//
+// the output of the job: out_file if set, else out_path or stdout
+//
+static bool open_job_output(const crc_job *job, emit_buf *out, size_t flush_at)
+{
+    if (job->out_file)
+        return emit_open_file(out, job->out_file, flush_at);
+
+    return emit_open(out, job->out_path, flush_at);
+}
+
+//
+// report a failure of the job on stderr, and to the client if served.
+// returns false
+//
+static bool job_error(const crc_job *job, const char *msg)
 {
-    int data_width, poly_width;
+    fprintf(stderr, "\n\terror: %s\n", msg);
+
+    if (job->error)
+        *job->error = msg;
 
-    // those MAX values can be larger - as soon as the PC has enough memory to allocate the matrices
-    const int DATA_WIDTH_MAX = 1024;
-    const int POLY_WIDTH_MAX = 1024;
+    return false;
+}
 
-    bool is_vhdl;
+//
+// options that can not be combined, returns the error message or NULL if the
+// job is fine. batch is set for --batch, whose jobs come from the manifest
+//
+const char *check_job_options(const crc_job *job, bool want_stats, bool batch)
+{
+    if (job->max_weight)
+        return "--max-weight only applies to analyze";
+
+    if (job->streaming && (job->use_cse || job->pipeline_stages || job->selfcheck))
+        return "--cse, --pipeline and --selfcheck need the full matrix, they can not be used with --stream";
+
+    if (job->use_cse && job->pipeline_stages)
+        return "--cse and --pipeline can not be combined";
+
+    if (job->byte_enables && (job->streaming || job->use_cse || job->pipeline_stages))
+        return "--byte-enables can not be combined with --stream, --cse or --pipeline";
+
+    if (job->lanes && (job->streaming || job->use_cse || job->pipeline_stages || job->byte_enables))
+        return "--lanes can not be combined with --stream, --cse, --pipeline or --byte-enables";
+
+    if (job->fold > 1 && (job->streaming || job->pipeline_stages || job->byte_enables || job->lanes))
+        return "--fold can not be combined with --stream, --pipeline, --byte-enables or --lanes";
+
+    if (job->lut6 && (job->streaming || job->use_cse || job->pipeline_stages || job->byte_enables || job->lanes))
+        return "--lut6 can not be combined with --stream, --cse, --pipeline, --byte-enables or --lanes";
+
+    if (job->channels && (job->use_cse || job->pipeline_stages || job->byte_enables || job->lanes || job->fold > 1 || job->lut6))
+        return "--channels can not be combined with --cse, --pipeline, --byte-enables, --lanes, --fold or --lut6";
+
+    if (job->scrambler && (job->streaming || job->use_cse || job->pipeline_stages || job->byte_enables || job->lanes || job->fold > 1 || job->lut6 || job->channels ||
+                           job->selfcheck || job->testbench || want_stats || job->export_path || job->throughput || batch))
+        return "--scrambler and --descrambler only take -o and -j";
+
+    if (job->export_path && (job->streaming || batch))
+        return "--export-matrix can not be used with --stream or --batch";
+
+    return NULL;
+}
+
+//
+// the output of the job: its throughput and/or the c header.
+// returns false if the output could not be written or the methods disagree.
+//
+bool generate_soft_crc(const crc_job *job, const gf2_word *lfsr_poly)
+{
+    gf2_word init[GF2_WORDS(SOFT_CRC_WIDTH_MAX)] = {0};
+    gf2_word xorout[GF2_WORDS(SOFT_CRC_WIDTH_MAX)] = {0};
+    const char *name = job->out_path ? job->out_path : "crc";
+    bool ok = true;
 
-    if (argc != 5)
+    // ~33 KB of tables, kept off the stack of the batch threads
+    soft_crc *engine = (soft_crc *)malloc(sizeof(soft_crc));
+
+    if (!engine)
+        return job_error(job, "failed mem allocation");
+
+    if (job->init_str)
+        parse_poly_string(job->init_str, job->poly_width, init);
+
+    if (job->xorout_str)
+        parse_poly_string(job->xorout_str, job->poly_width, xorout);
+
+    soft_crc_setup(engine,
+                   job->poly_width,
+                   lfsr_poly,
+                   job->init_str ? init : NULL,
+                   job->xorout_str ? xorout : NULL,
+                   job->input_inv,
+                   job->output_inv);
+
+    if (job->throughput && !soft_crc_bench(stderr, name, engine, (size_t)64 << 20))
+        ok = false;
+
+    if (job->language == LANG_C)
     {
-        print_usage();
-        exit(1);
+        emit_buf out;
+
+        if (!open_job_output(job, &out, 0))
+        {
+            fprintf(stderr, "\n\terror: cannot open output file %s\n", job->out_path);
+            free(engine);
+            return false;
+        }
+
+        print_c_crc(&out, engine, job->data_width);
+
+        if (!emit_close(&out))
+        {
+            fprintf(stderr, "\n\terror: failed to write output %s\n", job->out_path ? job->out_path : "");
+            ok = false;
+        }
     }
 
-    if (!strcmp(argv[1], "verilog"))
+    free(engine);
+
+    return ok;
+}
+
+//
+// testbench and golden vectors for the module written to job->out_path
+//
+bool generate_testbench(const crc_job *job, const gf2_word *lfsr_poly)
+{
+    int poly_width = job->poly_width;
+    std::vector<gf2_word> init(GF2_WORDS(poly_width));
+    std::vector<gf2_word> xorout(GF2_WORDS(poly_width));
+
+    // INIT defaults to all ones as in the HDL
+    if (job->init_str)
     {
-        is_vhdl = false;
+        parse_poly_string(job->init_str, poly_width, &init[0]);
     }
-    else if (!strcmp(argv[1], "vhdl"))
+    else
+    {
+        for (int n = 0; n < poly_width; n++)
+            gf2_set(&init[0], n);
+    }
+
+    if (job->xorout_str)
+        parse_poly_string(job->xorout_str, poly_width, &xorout[0]);
+
+    // <dir>/<base>.<ext> -> <dir>/<base>_tb.v and <dir>/<base>_tb.mem
+    const char *path = job->out_path;
+    const char *slash = strrchr(path, '/');
+    const char *bslash = strrchr(path, '\\');
+    const char *file = slash > bslash ? slash + 1 : (bslash ? bslash + 1 : path);
+    const char *dot = strrchr(file, '.');
+    std::string base(path, dot && dot != file ? dot : path + strlen(path));
+    std::string tb_path = base + (job->language == LANG_VHDL ? "_tb.vhd" : "_tb.v");
+    std::string mem_path = base + "_tb.mem";
+    const char *mem_name = mem_path.c_str() + (file - path);
+
+    testbench_params p;
+
+    p.is_vhdl = job->language == LANG_VHDL;
+    p.lfsr_poly_size = poly_width;
+    p.num_data_bits = job->data_width;
+    p.lfsr_poly = lfsr_poly;
+    p.init = &init[0];
+    p.xorout = &xorout[0];
+    p.input_inv = job->input_inv;
+    p.output_inv = job->output_inv;
+    p.latency = job->channels || job->lanes ? 1 : job->pipeline_stages; // the RAM read or the lane register
+    p.byte_enables = job->byte_enables;
+    p.fold = job->fold;
+    p.channels = job->channels;
+    p.cycles = job->vectors;
+
+    return write_testbench(path, &p, tb_path.c_str(), mem_path.c_str(), mem_name);
+}
+
+//
+// free the equation rows, or unmap them if they came from the cache
+//
+static void release_rows(gf2_matrix *rows, matrix_map *map)
+{
+    if (map->base)
     {
-        is_vhdl = true;
+        matrix_unmap(map);
+        rows->bits = NULL;
     }
     else
     {
-        print_usage();
-        exit(1);
+        gf2_matrix_free(rows);
     }
+}
+
+//
+// scrambler or descrambler for the job instead of the CRC module
+//
+bool generate_scrambler(const crc_job *job, const gf2_word *lfsr_poly)
+{
+    gf2_matrix matrix;
+    emit_buf out;
+
+    if (!gf2_matrix_alloc(&matrix, job->poly_width + job->data_width, job->poly_width + job->data_width))
+        return job_error(job, "failed mem allocation");
 
-    data_width = atoi(argv[2]);
+    build_scrambler_matrix(job->poly_width,
+                           lfsr_poly,
+                           job->data_width,
+                           job->scrambler,
+                           job->descramble,
+                           &matrix,
+                           job->num_threads);
 
-    if (data_width < 1 || data_width > DATA_WIDTH_MAX)
+    if (!open_job_output(job, &out, 0))
     {
-        fprintf(stderr, "\n\terror: invalid data_width\n");
-        exit(1);
+        fprintf(stderr, "\n\terror: cannot open output file %s\n", job->out_path);
+        gf2_matrix_free(&matrix);
+        return false;
     }
 
-    poly_width = atoi(argv[3]);
+    if (job->language == LANG_VHDL)
+        print_vhdl_scrambler(&out, job->poly_width, job->data_width, lfsr_poly, job->scrambler, job->descramble, &matrix);
+    else
+        print_verilog_scrambler(&out, job->poly_width, job->data_width, lfsr_poly, job->scrambler, job->descramble, &matrix);
+
+    gf2_matrix_free(&matrix);
 
-    if (poly_width < 1 || poly_width > POLY_WIDTH_MAX)
+    if (!emit_close(&out))
     {
-        fprintf(stderr, "\n\terror: invalid poly_width\n");
-        exit(1);
+        fprintf(stderr, "\n\terror: failed to write output %s\n", job->out_path ? job->out_path : "");
+        return false;
     }
 
-    char *poly_str = argv[4];
-    int poly_str_len = (int)strlen(poly_str);
+    return true;
+}
+
+//
+// build and print one CRC module. chain, if given, holds the precomputed
+// A^k*f sequence of this polynomial (see build_crc_chain).
+// returns false if the output could not be written.
+//
+bool generate_crc(const crc_job *job, const gf2_word *lfsr_poly, const gf2_matrix *chain)
+{
+    int poly_width = job->poly_width;
+    int data_width = job->data_width / job->fold; // the equations take one slice
+    crc_equations lfsr_eq;
+
+    if (job->scrambler)
+        return generate_scrambler(job, lfsr_poly);
 
-    if (poly_str_len < (poly_width + 3) / 4)
+    if (job->language == LANG_C || job->throughput)
     {
-        fprintf(stderr, "\n\terror: invalid poly string\n");
-        exit(1);
+        if (!generate_soft_crc(job, lfsr_poly))
+            return false;
+
+        if (job->language == LANG_C)
+            return true;
     }
 
-    unsigned int *lfsr_poly_array = (unsigned int *)malloc(sizeof(unsigned int) * poly_width);
-    unsigned int *lfsr_matrix = (unsigned int *)malloc(sizeof(unsigned int) * (data_width + poly_width) * poly_width);
+    lfsr_eq.lfsr_poly_size = poly_width;
+    lfsr_eq.num_data_bits = data_width;
+    lfsr_eq.lfsr_poly = lfsr_poly;
+    lfsr_eq.streaming = job->streaming;
+    lfsr_eq.first_row = 0;
+    lfsr_eq.num_shared = 0;
+    lfsr_eq.shared_pairs = NULL;
+    lfsr_eq.pipeline = NULL;
+    lfsr_eq.num_keep_sets = 0;
+    lfsr_eq.keep_rows = NULL;
+    lfsr_eq.lanes = NULL;
+    lfsr_eq.fold = job->fold;
+    lfsr_eq.lut6 = NULL;
+    lfsr_eq.rows.bits = NULL;
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    // a cached matrix is used in place from its mapping, also when streaming
+    std::string cache_path;
+    matrix_map cache_map;
+    bool cached = false;
+
+    cache_map.base = NULL;
+
+    // partial beat equation sets, all read from one A^k*f chain
+    std::vector<gf2_matrix> keep_rows;
+    gf2_matrix own_chain;
+    std::vector<int> shared_pairs;
+
+    // the printers read the top level from rows, the flat matrix is only kept
+    // for --selfcheck in the form the lut6 groups compute it
+    crc_lut6 lut6;
+    crc_pipeline pipeline;
+    crc_lanes lanes;
+    gf2_matrix flat_check;
+
+    own_chain.bits = NULL;
+    lut6.rows.bits = NULL;
+    lanes.lane_rows.bits = NULL;
+    lanes.combine.bits = NULL;
+    flat_check.bits = NULL;
+
+    // everything built so far, also on a failure: the server keeps running
+    auto release = [&]()
+    {
+        release_rows(&lfsr_eq.rows, &cache_map);
+
+        for (size_t b = 0; b < keep_rows.size(); b++)
+            gf2_matrix_free(&keep_rows[b]);
+
+        gf2_matrix_free(&own_chain);
+        free_lanes(&lanes);
+        free_lut6(&lut6);
+        gf2_matrix_free(&flat_check);
+    };
 
-    if (!lfsr_poly_array || !lfsr_matrix)
+    // the server keeps recent matrices in memory, ahead of the disk cache
+    bool in_lru = job->lru && !job->streaming && matrix_lru_get(job->lru, poly_width, data_width, lfsr_poly, &lfsr_eq.rows);
+
+    if (job->cache_dir && !in_lru)
     {
-        fprintf(stderr, "\n\terror: falied mem allocation\n");
-        exit(1);
+        cache_path = matrix_cache_path(job->cache_dir, poly_width, data_width, lfsr_poly);
+        cached = matrix_file_map(cache_path.c_str(), poly_width, data_width, lfsr_poly, &lfsr_eq.rows, &cache_map);
+
+        if (cached)
+            lfsr_eq.streaming = false;
     }
 
-    for (int i = 0; i < poly_width; i++)
+    if (!cached && !in_lru)
     {
-        char cur_byte = poly_str[poly_str_len - 1 - i / 4];
-        char nibble;
+        if (!gf2_matrix_alloc(&lfsr_eq.rows, job->streaming ? CRC_STREAM_ROWS : poly_width, poly_width + data_width))
+            return job_error(job, "failed mem allocation");
+
+        if (job->streaming)
+            lfsr_eq.rows.rows = 0; // rows are filled by crc_equation()
+        else if (job->use_serial_builder)
+            build_crc_matrix(poly_width,
+                             lfsr_poly,
+                             data_width,
+                             &lfsr_eq.rows,
+                             job->num_threads);
+        else if (!build_crc_matrix_fast(poly_width,
+                                        lfsr_poly,
+                                        data_width,
+                                        &lfsr_eq.rows,
+                                        0,
+                                        chain))
+        {
+            release();
+            return job_error(job, "failed mem allocation");
+        }
+    }
 
-        if (cur_byte >= '0' && cur_byte <= '9')
-            nibble = cur_byte - '0';
-        else if (cur_byte >= 'a' && cur_byte <= 'f')
-            nibble = 10 + cur_byte - 'a';
-        else if (cur_byte >= 'A' && cur_byte <= 'F')
-            nibble = 10 + cur_byte - 'A';
-        else
+    if (job->lru && !in_lru && !lfsr_eq.streaming &&
+        !matrix_lru_put(job->lru, poly_width, data_width, lfsr_poly, &lfsr_eq.rows))
+    {
+        release();
+        return job_error(job, "failed mem allocation");
+    }
+
+    // a failed store only costs the next run a rebuild
+    if (job->cache_dir && !cached && !in_lru && !lfsr_eq.streaming &&
+        !matrix_file_write(cache_path.c_str(), poly_width, data_width, lfsr_poly, &lfsr_eq.rows))
+        fprintf(stderr, "%s: warning: cannot write cache entry %s\n", job->out_path ? job->out_path : "crc", cache_path.c_str());
+
+    if (job->export_path && !matrix_file_write(job->export_path, poly_width, data_width, lfsr_poly, &lfsr_eq.rows))
+    {
+        fprintf(stderr, "\n\terror: failed to write output %s\n", job->export_path);
+        release();
+        return false;
+    }
+
+    if (job->byte_enables)
+    {
+        if (!chain)
         {
-            free(lfsr_poly_array);
-            free(lfsr_matrix);
-            fprintf(stderr, "\n\terror: invalid poly string \n");
-            exit(1);
+            if (!gf2_matrix_alloc(&own_chain, data_width, poly_width))
+            {
+                release();
+                return job_error(job, "failed mem allocation");
+            }
+
+            build_crc_chain(poly_width, lfsr_poly, &own_chain);
+            chain = &own_chain;
         }
 
-        lfsr_poly_array[i] = 1 & (nibble >> (i % 4));
+        keep_rows.resize(data_width / 8 - 1);
+
+        for (size_t b = 0; b < keep_rows.size(); b++)
+        {
+            if (!gf2_matrix_alloc(&keep_rows[b], poly_width, poly_width + 8 * ((int)b + 1)) ||
+                !build_crc_matrix_fast(poly_width,
+                                       lfsr_poly,
+                                       8 * ((int)b + 1),
+                                       &keep_rows[b],
+                                       0,
+                                       chain))
+            {
+                release();
+                return job_error(job, "failed mem allocation");
+            }
+        }
+
+        lfsr_eq.num_keep_sets = (int)keep_rows.size();
+        lfsr_eq.keep_rows = keep_rows.empty() ? &lfsr_eq.rows : &keep_rows[0];
+        gf2_matrix_free(&own_chain);
     }
 
-    memset(lfsr_matrix, 0, sizeof(unsigned int) * (data_width + poly_width) * poly_width);
+    // the flat equations; streamed rows are built here for the first time
+    if (job->stats)
+    {
+        double build_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
 
-    build_crc_matrix(poly_width,
-                     lfsr_poly_array,
-                     data_width,
-                     lfsr_matrix);
+        for (int n2 = 0; n2 < poly_width; n2++)
+        {
+            const gf2_word *row = crc_equation(&lfsr_eq, n2);
 
-    if (is_vhdl)
-        print_vhdl_crc(poly_width,
-                       data_width,
-                       lfsr_poly_array,
-                       lfsr_matrix);
-    else
-        print_verilog_crc(poly_width,
-                          data_width,
-                          lfsr_poly_array,
-                          lfsr_matrix);
+            if (!row)
+            {
+                release();
+                return job_error(job, "failed mem allocation");
+            }
 
-    free(lfsr_poly_array);
-    free(lfsr_matrix);
-    return 0;
-}
+            crc_stats_add_row(job->stats, n2, row);
+        }
 
-void build_crc_matrix(int lfsr_poly_size,
-                      unsigned int *lfsr_poly_array,
-                      int num_data_bits,
-                      unsigned int *lfsr_matrix)
-{
-    int N = lfsr_poly_size;
-    int M = num_data_bits;
-    int n1, n2, m1;
+        job->stats->build_s = lfsr_eq.streaming ? std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() : build_s;
+    }
+
+    // the flat equations are only built to weigh the fold against them
+    if (job->fold > 1)
+    {
+        gf2_matrix flat;
+
+        if (!gf2_matrix_alloc(&flat, poly_width, poly_width + job->data_width) ||
+            !build_crc_matrix_fast(poly_width, lfsr_poly, job->data_width, &flat, 0, NULL))
+        {
+            gf2_matrix_free(&flat);
+            release();
+            return job_error(job, "failed mem allocation");
+        }
+
+        report_fold(stderr, job->out_path ? job->out_path : "crc", &flat, &lfsr_eq.rows, poly_width, job->data_width, job->fold);
+        gf2_matrix_free(&flat);
+    }
+
+    if (job->use_cse)
+    {
+        gf2_matrix shared_rows;
+
+        if (!xor_cse(&lfsr_eq.rows, &shared_rows, &shared_pairs))
+        {
+            release();
+            return job_error(job, "failed mem allocation");
+        }
 
-    unsigned int *lfsr_cur = (unsigned int *)malloc(sizeof(unsigned int) * N);
-    unsigned int *lfsr_next = (unsigned int *)malloc(sizeof(unsigned int) * N);
-    unsigned int *data_cur = (unsigned int *)malloc(sizeof(unsigned int) * M);
+        lfsr_eq.num_shared = (int)shared_pairs.size() / 2;
+        lfsr_eq.shared_pairs = lfsr_eq.num_shared ? &shared_pairs[0] : NULL;
 
-    ////////////////////////////////////
-    for (n1 = 0; n1 < N; n1++)
-        lfsr_cur[n1] = 0;
+        fprintf(stderr, "%s: xor2 gates %d flat, %d with %d shared terms\n",
+                job->out_path ? job->out_path : "crc",
+                xor2_count(&lfsr_eq.rows, 0),
+                xor2_count(&shared_rows, lfsr_eq.num_shared),
+                lfsr_eq.num_shared);
 
-    for (m1 = 0; m1 < M; m1++)
-        data_cur[m1] = 0;
+        release_rows(&lfsr_eq.rows, &cache_map);
+        lfsr_eq.rows = shared_rows;
+    }
 
-    // LFSR-2-LFSR matrix[NxN], data_cur=0
-    for (n1 = 0; n1 < N; n1++)
+    if (job->lut6)
     {
-        lfsr_cur[n1] = 1;
+        if (!map_lut6(&lfsr_eq.rows, &lut6) ||
+            (job->selfcheck && !compose_lut6(&lut6, &flat_check)))
+        {
+            release();
+            return job_error(job, "failed mem allocation");
+        }
 
-        if (n1)
-            lfsr_cur[n1 - 1] = 0;
+        report_lut6(stderr, job->out_path ? job->out_path : "crc", &lfsr_eq.rows, &lut6);
 
-        lfsr_serial_shift_crc(M,
-                              N,
-                              lfsr_poly_array,
-                              lfsr_cur,
-                              lfsr_next,
-                              M,
-                              data_cur);
+        release_rows(&lfsr_eq.rows, &cache_map);
+        lfsr_eq.rows = lut6.rows;
+        lut6.rows.bits = NULL;
+        lfsr_eq.lut6 = &lut6;
+    }
+
+    if (job->pipeline_stages)
+    {
+        plan_pipeline(&lfsr_eq.rows, poly_width, data_width, job->pipeline_stages, &pipeline);
+        report_pipeline(stderr, job->out_path ? job->out_path : "crc", &lfsr_eq.rows, poly_width, &pipeline);
+        lfsr_eq.pipeline = &pipeline;
+    }
 
-        for (n2 = 0; n2 < N; n2++)
+    if (job->lanes)
+    {
+        if (!plan_lanes(&lfsr_eq.rows, poly_width, data_width, job->lanes, &lanes))
+        {
+            release();
+            return job_error(job, "failed mem allocation");
+        }
+
+        report_lanes(stderr, job->out_path ? job->out_path : "crc", &lfsr_eq.rows, poly_width, &lanes);
+
+        release_rows(&lfsr_eq.rows, &cache_map);
+        lfsr_eq.rows = lanes.combine;
+        lanes.combine.bits = NULL;
+        lfsr_eq.lanes = &lanes;
+    }
+
+    // every equation set as printed, the partial beats first
+    for (int b = 0; job->selfcheck && b <= lfsr_eq.num_keep_sets; b++)
+    {
+        selfcheck_equations eq;
+        bool last = b == lfsr_eq.num_keep_sets;
+
+        eq.rows = last ? (lfsr_eq.lut6 ? &flat_check : &lfsr_eq.rows) : &lfsr_eq.keep_rows[b];
+        eq.data_width = last ? data_width : 8 * (b + 1);
+        eq.num_shared = last ? lfsr_eq.num_shared : 0;
+        eq.shared_pairs = lfsr_eq.shared_pairs;
+        eq.pipeline = last ? lfsr_eq.pipeline : NULL;
+        eq.lanes = last ? lfsr_eq.lanes : NULL;
+
+        if (!selfcheck_crc(stderr,
+                           job->out_path ? job->out_path : "crc",
+                           poly_width,
+                           lfsr_poly,
+                           &eq,
+                           job->vectors,
+                           SELFCHECK_BEATS,
+                           job->num_threads))
         {
-            if (lfsr_next[n2])
-                lfsr_matrix[n1 * N + n2] = 1;
+            release();
+            return false;
         }
     }
 
-    ////////////////////////////////////
-    for (n1 = 0; n1 < N; n1++)
-        lfsr_cur[n1] = 0;
+    // one write at the end, or 1 MB chunks when streaming
+    emit_buf out;
 
-    for (m1 = 0; m1 < M; m1++)
-        data_cur[m1] = 0;
+    t0 = std::chrono::steady_clock::now();
 
-    // Data-2-LFSR matrix[MxN], lfsr_cur=0
-    for (m1 = 0; m1 < M; m1++)
+    if (!open_job_output(job, &out, job->streaming ? (size_t)1 << 20 : 0))
     {
-        data_cur[m1] = 1;
+        fprintf(stderr, "\n\terror: cannot open output file %s\n", job->out_path);
+        release();
+        return false;
+    }
 
-        if (m1)
-            data_cur[m1 - 1] = 0;
+    if (job->channels)
+    {
+        report_channels(stderr, job->out_path ? job->out_path : "crc", poly_width, job->channels);
 
-        lfsr_serial_shift_crc(M,
-                              N,
-                              lfsr_poly_array,
-                              lfsr_cur,
-                              lfsr_next,
-                              M,
-                              data_cur);
+        if (job->language == LANG_VHDL)
+            print_vhdl_crc_channels(&out, poly_width, job->data_width, lfsr_poly, &lfsr_eq, job->channels);
+        else
+            print_verilog_crc_channels(&out, poly_width, job->data_width, lfsr_poly, &lfsr_eq, job->channels);
+    }
+    else if (job->language == LANG_VHDL)
+        print_vhdl_crc(&out,
+                       poly_width,
+                       job->data_width,
+                       lfsr_poly,
+                       &lfsr_eq);
+    else
+        print_verilog_crc(&out,
+                          poly_width,
+                          job->data_width,
+                          lfsr_poly,
+                          &lfsr_eq);
+
+    release();
 
-        // Data-2-LFSR matrix[MxN]
-        // Invert CRC data bits
-        for (n2 = 0; n2 < N; n2++)
+    if (!emit_close(&out))
+    {
+        fprintf(stderr, "\n\terror: failed to write output %s\n", job->out_path ? job->out_path : "");
+        return false;
+    }
+
+    if (job->stats)
+    {
+        const char *name = job->out_path ? job->out_path : "crc";
+
+        job->stats->print_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        job->stats->bytes = out.bytes;
+
+        if (!job->stats_json)
+        {
+            print_crc_stats(stderr, name, job->stats);
+        }
+        else if (!write_crc_stats_json(job->stats_json, name, job->stats))
         {
-            if (lfsr_next[n2])
-                lfsr_matrix[N * N + (M - m1 - 1) * N + n2] = 1;
+            fprintf(stderr, "\n\terror: failed to write output %s\n", job->stats_json);
+            return false;
         }
     }
 
-    free(lfsr_cur);
-    free(lfsr_next);
-    free(data_cur);
+    if (job->testbench)
+        return generate_testbench(job, lfsr_poly);
 
-} // build_matrices_crc
+    return true;
+}
 
 //
-// generate verilog code for this CRC
+// generate every module listed in a manifest
 //
-void print_verilog_crc(int lfsr_poly_size,
-                       int num_data_bits,
-                       unsigned int *lfsr_poly_array,
-                       unsigned int *lfsr_matrix)
+// jobs are grouped by polynomial and each group gets one A^k*f chain, as long
+// as its widest data bus, which every job of the group then reads its matrix
+// from. the chains and then the jobs are spread over num_threads threads.
+//
+int run_batch(const char *manifest_path, const crc_job *defaults)
 {
-    fprintf(stdout, "\n//-----------------------------------------------------------------------------");
-    fprintf(stdout, "\n// Copyright (C) 2009 OutputLogic.com");
-    fprintf(stdout, "\n// This source file may be used and distributed without restriction");
-    fprintf(stdout, "\n// provided that this copyright statement is not removed from the file");
-    fprintf(stdout, "\n// and that any derivative work contains the original copyright notice");
-    fprintf(stdout, "\n// and the associated disclaimer.");
-    fprintf(stdout, "\n// THIS SOURCE FILE IS PROVIDED \"AS IS\" AND WITHOUT ANY EXPRESS");
-    fprintf(stdout, "\n// OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED	");
-    fprintf(stdout, "\n// WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.");
-    fprintf(stdout, "\n//-----------------------------------------------------------------------------\n");
-
-    int N = lfsr_poly_size;
-    int M = num_data_bits;
-    int n1, n2, m1;
-
-    fprintf(stdout, "// CRC module for\n");
-    fprintf(stdout, "//    data[%d:0]\n", num_data_bits - 1);
-    fprintf(stdout, "//    crc[%d:0]=", lfsr_poly_size - 1);
-
-    for (int l = 0; l < lfsr_poly_size; l++)
-    {
-        if (lfsr_poly_array[l])
-        {
-            if (l)
-                fprintf(stdout, "+x^%d", l);
-            else
-                fprintf(stdout, "1");
+    FILE *fp = fopen(manifest_path, "rb");
+
+    if (!fp)
+    {
+        fprintf(stderr, "\n\terror: cannot open manifest %s\n", manifest_path);
+        return 1;
+    }
+
+    // the job strings point into this buffer, it lives until the end
+    std::vector<char> text;
+    char chunk[4096];
+    size_t n;
+
+    while ((n = fread(chunk, 1, sizeof(chunk), fp)) > 0)
+        text.insert(text.end(), chunk, chunk + n);
+
+    fclose(fp);
+    text.push_back('\0');
+
+    std::vector<crc_job> jobs;
+    std::vector<int> job_group;
+
+    // polynomials, their widest data bus and their chain
+    std::vector<std::vector<gf2_word>> polys;
+    std::vector<int> poly_widths;
+    std::vector<int> max_data_widths;
+
+    char *line = &text[0];
+    int line_no = 0;
+
+    while (line)
+    {
+        char *next = strchr(line, '\n');
+
+        if (next)
+            *next++ = '\0';
+
+        line_no++;
+
+        char *tok[6];
+        int tok_cnt = 0;
+
+        for (char *t = strtok(line, " \t\r"); t && tok_cnt < 6; t = strtok(NULL, " \t\r"))
+            tok[tok_cnt++] = t;
+
+        line = next;
+
+        if (!tok_cnt || tok[0][0] == '#')
+            continue;
+
+        crc_job job = *defaults;
+        const char *err = tok_cnt == 5 ? parse_crc_params(&job, tok[0], tok[1], tok[2], tok[3]) : "expected 'language data_width poly_width poly_string output_file'";
+        std::vector<gf2_word> poly;
+
+        if (!err)
+        {
+            poly.assign(GF2_WORDS(job.poly_width), 0);
+
+            if (!parse_poly_string(job.poly_str, job.poly_width, &poly[0]))
+                err = "invalid poly string";
         }
+
+        if (err)
+        {
+            fprintf(stderr, "\n\terror: %s:%d: %s\n", manifest_path, line_no, err);
+            return 1;
+        }
+
+        job.out_path = tok[4];
+        job.streaming = false;
+        job.num_threads = 1;
+
+        size_t g;
+
+        for (g = 0; g < polys.size(); g++)
+        {
+            if (poly_widths[g] == job.poly_width && polys[g] == poly)
+                break;
+        }
+
+        if (g == polys.size())
+        {
+            polys.push_back(poly);
+            poly_widths.push_back(job.poly_width);
+            max_data_widths.push_back(0);
+        }
+
+        if (max_data_widths[g] < job.data_width)
+            max_data_widths[g] = job.data_width;
+
+        jobs.push_back(job);
+        job_group.push_back((int)g);
     }
-    fprintf(stdout, "+x^%d;\n\n", lfsr_poly_size);
 
-    fprintf(stdout, "\n");
+    std::vector<gf2_matrix> chains(polys.size());
 
-    fprintf(stdout, "module crc #(\n");
-    fprintf(stdout, "    parameter INPUT_WIDTH  = %d,\n", num_data_bits);
-    fprintf(stdout, "    parameter OUTPUT_WIDTH = %d,\n", lfsr_poly_size);
-    fprintf(stdout, "    parameter INIT         = {%d{1'b1}},\n",lfsr_poly_size);
-    fprintf(stdout, "    parameter OUTPUT_XOR   = {%d{1'b0}},\n",lfsr_poly_size);
-    fprintf(stdout, "    parameter INPUT_INV    = 1'b0,\n");
-    fprintf(stdout, "    parameter OUTPUT_INV   = 1'b0\n");
-    fprintf(stdout, ") (\n");
-    fprintf(stdout, "    input  wire [ (INPUT_WIDTH-1):0] data_in,\n");
-    fprintf(stdout, "    input  wire                      crc_en,\n");
-    fprintf(stdout, "    output wire [(OUTPUT_WIDTH-1):0] crc_out,\n");
-    fprintf(stdout, "    input  wire                      rst,\n");
-    fprintf(stdout, "    input  wire                      clk\n");
-    fprintf(stdout, ");\n");
+    parallel_for((int)polys.size(), defaults->num_threads, [&](int g, int)
+                 {
+                     if (!gf2_matrix_alloc(&chains[g], max_data_widths[g], poly_widths[g]))
+                     {
+                         fprintf(stderr, "\n\terror: failed mem allocation\n");
+                         exit(1);
+                     }
 
-    fprintf(stdout, "\n");
+                     build_crc_chain(poly_widths[g], &polys[g][0], &chains[g]);
+                 });
 
-    fprintf(stdout, "    genvar ii;\n");
-    fprintf(stdout, "    wire [ (INPUT_WIDTH-1):0] data_in_inv;\n");
-    fprintf(stdout, "    wire [ (INPUT_WIDTH-1):0] data_in_inv_res;\n");
-    fprintf(stdout, "    wire [(OUTPUT_WIDTH-1):0] crc_out_inv;\n");
-    fprintf(stdout, "    wire [(OUTPUT_WIDTH-1):0] crc_out_inv_res;\n");
-    fprintf(stdout, "    reg  [(OUTPUT_WIDTH-1):0] lfsr_q;\n");
-    fprintf(stdout, "    reg  [(OUTPUT_WIDTH-1):0] lfsr_c;\n");
+    std::atomic<int> failed(0);
 
-    fprintf(stdout, "\n");
+    parallel_for((int)jobs.size(), defaults->num_threads, [&](int j, int)
+                 {
+                     int g = job_group[j];
 
-    fprintf(stdout, "    generate\n");
-    fprintf(stdout, "        for (ii = 0; ii < INPUT_WIDTH; ii = ii + 1) begin\n");
-    fprintf(stdout, "            assign data_in_inv[ii] = data_in[INPUT_WIDTH-ii-1];\n");
-    fprintf(stdout, "        end\n");
-    fprintf(stdout, "        for (ii = 0; ii < OUTPUT_WIDTH; ii = ii + 1) begin\n");
-    fprintf(stdout, "            assign crc_out_inv[ii] = lfsr_q[OUTPUT_WIDTH-ii-1];\n");
-    fprintf(stdout, "        end\n");
-    fprintf(stdout, "    endgenerate\n");
+                     if (!generate_crc(&jobs[j], &polys[g][0], &chains[g]))
+                         failed++;
+                 });
 
-    fprintf(stdout, "\n");
+    for (size_t g = 0; g < chains.size(); g++)
+        gf2_matrix_free(&chains[g]);
 
-    fprintf(stdout, "    // input reverse\n");
-    fprintf(stdout, "    assign data_in_inv_res = (INPUT_INV == 1'b1) ? (data_in_inv) : data_in;\n");
-    fprintf(stdout, "    // output reverse\n");
-    fprintf(stdout, "    assign crc_out_inv_res = (OUTPUT_INV == 1'b1) ? (crc_out_inv) : lfsr_q;\n");
-    fprintf(stdout, "    // output xor\n");
-    fprintf(stdout, "    assign crc_out         = crc_out_inv_res ^ OUTPUT_XOR;\n");
+    return failed ? 1 : 0;
+}
 
-    fprintf(stdout, "\n");
+//
+// analyze every polynomial of poly_list at every data length of len_list,
+// both comma separated, and print them best first
+//
+int run_analyze(const crc_job *defaults, const char *len_list, const char *poly_width_str, const char *poly_list, int num_threads)
+{
+    int N = atoi(poly_width_str);
+    int max_weight = defaults->max_weight ? defaults->max_weight : HD_WEIGHT_MAX;
+    std::vector<int> lengths;
+    std::vector<std::string> poly_strs;
 
-    fprintf(stdout, "    always @(*) begin");
+    if (N < 1 || N > HD_POLY_WIDTH_MAX)
+    {
+        fprintf(stderr, "\n\terror: poly_width must be 1..%d to analyze\n", HD_POLY_WIDTH_MAX);
+        exit(1);
+    }
 
-    // print columns of LFSR[(N+M)xN] matrix
-    // go thru each column[n2]
-    for (n2 = 0; n2 < N; n2++)
+    for (const char *p = len_list; *p; p += *p == ',')
     {
-        fprintf(stdout, "\n        lfsr_c[%d] = ", n2);
-        bool is_first = true;
+        char *end;
+        long len = strtol(p, &end, 10);
 
-        for (n1 = 0; n1 < N; n1++)
+        if (end == p || len < 1 || len > DATA_WIDTH_MAX || (*end && *end != ','))
         {
-            if (lfsr_matrix[n1 * N + n2])
-            {
-                if (is_first)
-                {
-                    fprintf(stdout, "lfsr_q[%d]", n1);
-                    is_first = false;
-                }
-                else
-                {
-                    fprintf(stdout, " ^ lfsr_q[%d]", n1);
-                }
-            }
+            fprintf(stderr, "\n\terror: invalid data length in %s\n", len_list);
+            exit(1);
         }
 
-        for (m1 = 0; m1 < M; m1++)
+        lengths.push_back((int)len);
+        p = end;
+    }
+
+    for (const char *p = poly_list; *p; p += *p == ',')
+    {
+        const char *end = strchr(p, ',');
+
+        if (!end)
+            end = p + strlen(p);
+
+        poly_strs.push_back(std::string(p, end));
+        p = end;
+    }
+
+    if (lengths.empty() || poly_strs.empty())
+    {
+        print_usage();
+        exit(1);
+    }
+
+    int num_lengths = (int)lengths.size();
+    std::vector<hd_spectrum> spectra(poly_strs.size() * num_lengths);
+
+    for (size_t k = 0; k < poly_strs.size(); k++)
+    {
+        gf2_word poly = 0;
+
+        if ((int)poly_strs[k].size() < (N + 3) / 4 || !parse_poly_string(poly_strs[k].c_str(), N, &poly))
         {
-            if (lfsr_matrix[N * N + m1 * N + n2])
-            {
-                if (is_first)
-                {
-                    fprintf(stdout, "data_in_inv_res[%d]", m1);
-                    is_first = false;
-                }
-                else
-                {
-                    fprintf(stdout, " ^ data_in_inv_res[%d]", m1);
-                }
-            }
+            fprintf(stderr, "\n\terror: invalid poly string %s\n", poly_strs[k].c_str());
+            exit(1);
         }
 
-        fprintf(stdout, ";");
+        hd_analyze(N, &poly, &lengths[0], num_lengths, max_weight, num_threads, &spectra[k * num_lengths]);
     }
-    fprintf(stdout, "\n    end // always\n\n");
 
-    fprintf(stdout, "    always @(posedge clk, posedge rst) begin\n");
-    fprintf(stdout, "        if (rst) begin\n");
-    fprintf(stdout, "            lfsr_q <= INIT;\n", lfsr_poly_size);
-    fprintf(stdout, "        end else begin\n");
-    fprintf(stdout, "            lfsr_q <= crc_en ? lfsr_c : lfsr_q;\n", lfsr_poly_size);
-    fprintf(stdout, "        end\n");
-    fprintf(stdout, "    end // always\n");
-    fprintf(stdout, "endmodule // crc\n");
-    fprintf(stdout, "\n");
+    std::vector<int> order(poly_strs.size());
+
+    for (size_t k = 0; k < order.size(); k++)
+        order[k] = (int)k;
 
-} // print_verilog_crc
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                     { return hd_better(&spectra[a * num_lengths], &spectra[b * num_lengths], num_lengths, max_weight); });
+
+    emit_buf out;
+
+    if (!emit_open(&out, defaults->out_path, 0))
+    {
+        fprintf(stderr, "\n\terror: cannot open output file %s\n", defaults->out_path);
+        exit(1);
+    }
+
+    emit_fmt(&out, "# undetected errors of %d bit CRC polynomials, g = x^%d + poly|1, over data_len bits\n", N, N);
+    emit_fmt(&out, "# and the %d CRC bits; hd >%d means none up to %d bits\n", N, max_weight, max_weight);
+    emit_fmt(&out, "%6s  %-18s %8s  %3s", "# rank", "poly", "data_len", "hd");
+
+    for (int w = 2; w <= max_weight; w++)
+        emit_fmt(&out, "  %13s%d", "w", w);
+
+    EMIT_LIT(&out, "\n");
+
+    for (size_t r = 0; r < order.size(); r++)
+    {
+        for (int l = 0; l < num_lengths; l++)
+            print_hd_spectrum(&out, (int)r + 1, poly_strs[order[r]].c_str(), &spectra[order[r] * num_lengths + l], max_weight);
+    }
+
+    emit_fmt(&out, "%s\n", poly_strs[order[0]].c_str());
+
+    if (!emit_close(&out))
+    {
+        fprintf(stderr, "\n\terror: failed to write output %s\n", defaults->out_path ? defaults->out_path : "");
+        return 1;
+    }
+
+    return 0;
+}
 
 //
-// Serially shift {data_in,lfsr_cur} N times to get {lfsr_next}
+// one request to the server: the options and parameters of a single module
+// as on the command line. options that write more files or report on stderr
+// are left to a local crc-gen
 //
-void lfsr_serial_shift_crc(int num_bits_to_shift,
-                           int lfsr_poly_size,
-                           unsigned int *lfsr_poly,
-                           unsigned int *lfsr_cur,
-                           unsigned int *lfsr_next,
-                           int num_data_bits,
-                           unsigned int *data_cur)
+static bool serve_request(void *ctx, int argc, char **argv, FILE *out, std::string *err)
 {
-    int i, j;
+    crc_job job = *(const crc_job *)ctx;
+    const char *pos_args[4];
+    int pos_cnt = 0;
+
+    job.out_file = out;
+    job.error = err;
 
-    if (num_bits_to_shift > num_data_bits)
+    for (int i = 0; i < argc; i++)
     {
-        fprintf(stderr, "error: [%d] > [%d]\n", num_bits_to_shift, num_data_bits);
-        return;
+        const char *arg = argv[i];
+        const char *val = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (!strcmp(arg, "--builder=serial") || !strcmp(arg, "--builder=fast"))
+            job.use_serial_builder = arg[10] == 's';
+        else if (!strcmp(arg, "--stream"))
+            job.streaming = true;
+        else if (!strcmp(arg, "--cse"))
+            job.use_cse = true;
+        else if (!strcmp(arg, "--lut6"))
+            job.lut6 = true;
+        else if (!strcmp(arg, "--byte-enables"))
+            job.byte_enables = true;
+        else if (!strcmp(arg, "--input-inv"))
+            job.input_inv = true;
+        else if (!strcmp(arg, "--output-inv"))
+            job.output_inv = true;
+        else if (!strcmp(arg, "--init") && val)
+            job.init_str = argv[++i];
+        else if (!strcmp(arg, "--output-xor") && val)
+            job.xorout_str = argv[++i];
+        else if ((!strcmp(arg, "--scrambler") || !strcmp(arg, "--descrambler")) && val)
+        {
+            job.descramble = arg[2] == 'd';
+            job.scrambler = !strcmp(val, "additive") ? SCRAMBLER_ADDITIVE : !strcmp(val, "self-sync") ? SCRAMBLER_SELF_SYNC : SCRAMBLER_NONE;
+            i++;
+
+            if (!job.scrambler)
+            {
+                *err = std::string("invalid ") + (arg + 2) + " type";
+                return false;
+            }
+        }
+        else if ((!strcmp(arg, "--pipeline") || !strcmp(arg, "--lanes") || !strcmp(arg, "--fold") || !strcmp(arg, "--channels")) && val)
+        {
+            int n = atoi(argv[++i]);
+
+            if (arg[2] == 'p' && (n < 1 || n > 16))
+                *err = "invalid --pipeline";
+            else if (arg[2] == 'c' && n > CRC_CHANNELS_MAX)
+                *err = "invalid --channels";
+            else if (arg[2] != 'p' && n < 2)
+                *err = std::string("invalid ") + arg;
+
+            if (!err->empty())
+                return false;
+
+            if (arg[2] == 'p')
+                job.pipeline_stages = n;
+            else if (arg[2] == 'l')
+                job.lanes = n;
+            else if (arg[2] == 'c')
+                job.channels = n;
+            else
+                job.fold = n;
+        }
+        else if (arg[0] == '-' || pos_cnt == 4)
+        {
+            *err = std::string(arg) + " is not served, run crc-gen without --client";
+            return false;
+        }
+        else
+        {
+            pos_args[pos_cnt++] = arg;
+        }
+    }
+
+    if (pos_cnt != 4)
+    {
+        *err = "expected language data_width poly_width poly_string";
+        return false;
     }
 
-    for (i = 0; i < lfsr_poly_size; i++)
-        lfsr_next[i] = lfsr_cur[i];
+    const char *msg = check_job_options(&job, false, false);
 
-    for (j = 0; j < num_bits_to_shift; j++)
+    if (!msg)
+        msg = parse_crc_params(&job, pos_args[0], pos_args[1], pos_args[2], pos_args[3]);
+
+    if (msg)
+    {
+        *err = msg;
+        return false;
+    }
+
+    std::vector<gf2_word> lfsr_poly(GF2_WORDS(job.poly_width));
+
+    if (!parse_poly_string(job.poly_str, job.poly_width, &lfsr_poly[0]))
     {
-        // shift the entire LFSR
-        unsigned int lfsr_upper_bit = lfsr_next[lfsr_poly_size - 1];
+        *err = "invalid poly string";
+        return false;
+    }
+
+    return generate_crc(&job, &lfsr_poly[0], NULL);
+}
 
-        for (i = lfsr_poly_size - 1; i > 0; i--)
+int main(int argc, char *argv[])
+{
+    crc_job job;
+
+    job.language = LANG_VERILOG;
+    job.data_width = 0;
+    job.poly_width = 0;
+    job.poly_str = NULL;
+    job.out_path = NULL;
+    job.out_file = NULL;
+    job.use_serial_builder = false;
+    job.streaming = false;
+    job.use_cse = false;
+    job.pipeline_stages = 0;
+    job.byte_enables = false;
+    job.lanes = 0;
+    job.fold = 1;
+    job.lut6 = false;
+    job.channels = 0;
+    job.scrambler = SCRAMBLER_NONE;
+    job.descramble = false;
+    job.num_threads = 1;
+    job.init_str = NULL;
+    job.xorout_str = NULL;
+    job.input_inv = false;
+    job.output_inv = false;
+    job.throughput = false;
+    job.selfcheck = false;
+    job.vectors = 1 << 20;
+    job.testbench = false;
+    job.stats = NULL;
+    job.stats_json = NULL;
+    job.cache_dir = getenv("CRC_GEN_CACHE");
+    job.export_path = NULL;
+    job.max_weight = 0;
+    job.lru = NULL;
+    job.error = NULL;
+
+    // thin client: the server gets the arguments but the socket and -o
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--client"))
+            continue;
+
+        std::vector<char *> args;
+        const char *socket_path = i + 1 < argc ? argv[i + 1] : NULL;
+
+        for (int k = 1; k < argc; k++)
         {
-            if (lfsr_poly[i])
-                lfsr_next[i] = lfsr_next[i - 1] ^ lfsr_upper_bit ^ data_cur[j];
+            if (k == i)
+                k++;
+            else if (!strcmp(argv[k], "-o") && k + 1 < argc)
+                job.out_path = argv[++k];
             else
-                lfsr_next[i] = lfsr_next[i - 1];
+                args.push_back(argv[k]);
         }
 
-        lfsr_next[0] = lfsr_upper_bit ^ data_cur[j];
+        if (!socket_path || args.empty())
+        {
+            print_usage();
+            exit(1);
+        }
+
+        return run_client(socket_path, (int)args.size(), &args[0], job.out_path);
     }
 
-} // lfsr_serial_shift
+    bool want_stats = false;
+    bool want_threads = false;
+    const char *serve_path = NULL;
+    int lru_mb = 0;
 
-void print_vhdl_crc(int lfsr_poly_size,
-                    int num_data_bits,
-                    unsigned int *lfsr_poly_array,
-                    unsigned int *lfsr_matrix)
-{
-    int N = lfsr_poly_size;
-    int M = num_data_bits;
-    int n1, n2, m1;
-
-    fprintf(stdout, "\n-------------------------------------------------------------------------------");
-    fprintf(stdout, "\n-- Copyright (C) 2009 OutputLogic.com");
-    fprintf(stdout, "\n-- This source file may be used and distributed without restriction");
-    fprintf(stdout, "\n-- provided that this copyright statement is not removed from the file");
-    fprintf(stdout, "\n-- and that any derivative work contains the original copyright notice");
-    fprintf(stdout, "\n-- and the associated disclaimer.");
-    fprintf(stdout, "\n-- THIS SOURCE FILE IS PROVIDED \"AS IS\" AND WITHOUT ANY EXPRESS");
-    fprintf(stdout, "\n-- OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED");
-    fprintf(stdout, "\n-- WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.");
-    fprintf(stdout, "\n-------------------------------------------------------------------------------\n");
-
-    fprintf(stdout, "-- CRC module for\n");
-    fprintf(stdout, "--    data(%d:0)\n", num_data_bits - 1);
-    fprintf(stdout, "--    crc(%d:0)=", lfsr_poly_size - 1);
-
-    for (int l = 0; l < lfsr_poly_size; l++)
-    {
-        if (lfsr_poly_array[l])
-        {
-            if (l)
-                fprintf(stdout, "+x^%d", l);
+    const char *manifest_path = NULL;
+
+    char *pos_args[4];
+    int pos_cnt = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strncmp(argv[i], "--builder=", 10))
+        {
+            if (!strcmp(argv[i] + 10, "serial"))
+                job.use_serial_builder = true;
+            else if (!strcmp(argv[i] + 10, "fast"))
+                job.use_serial_builder = false;
             else
-                fprintf(stdout, "1");
-        }
-    }
-    fprintf(stdout, "+x^%d;\n\n", lfsr_poly_size);
-
-    fprintf(stdout, "library ieee;                   \n");
-    fprintf(stdout, "use ieee.std_logic_1164.all;    \n");
-    fprintf(stdout, "\n-------------------------------------------------------------------------------\n");
-
-    fprintf(stdout, "entity crc is\n");
-    fprintf(stdout, "    generic (\n");
-    fprintf(stdout, "        INPUT_WIDTH  : integer := %d;\n", num_data_bits);
-    fprintf(stdout, "        OUTPUT_WIDTH : integer := %d;\n", lfsr_poly_size);
-    fprintf(stdout, "        INIT         : std_logic_vector(%d downto 0) := (others => '1');\n", lfsr_poly_size - 1);
-    fprintf(stdout, "        OUTPUT_XOR   : std_logic_vector(%d downto 0) := (others => '0');\n", lfsr_poly_size - 1);
-    fprintf(stdout, "        INPUT_INV    : std_logic := '0';\n");
-    fprintf(stdout, "        OUTPUT_INV   : std_logic := '0'\n");
-    fprintf(stdout, "    );\n");
-    fprintf(stdout, "    port (\n");
-    fprintf(stdout, "        data_in : in  std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "        crc_en  : in  std_logic;\n");
-    fprintf(stdout, "        crc_out : out std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "        rst     : in  std_logic;\n");
-    fprintf(stdout, "        clk     : in  std_logic\n");
-    fprintf(stdout, "    );\n");
-    fprintf(stdout, "end entity crc;\n");
-
-    fprintf(stdout, "architecture imp_crc of crc is	 \n");
-    fprintf(stdout, "    signal data_in_inv      : std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "    signal data_in_inv_res  : std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "    signal crc_out_inv      : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "    signal crc_out_inv_res  : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "    signal lfsr_q           : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "    signal lfsr_c           : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
-    fprintf(stdout, "begin\n\n");
-
-    fprintf(stdout, "    -- input reverse\n");
-    fprintf(stdout, "    gen_data_in_inv: for ii in 0 to INPUT_WIDTH-1 generate\n");
-    fprintf(stdout, "        data_in_inv(ii) <= data_in(INPUT_WIDTH-ii-1);\n");
-    fprintf(stdout, "    end generate gen_data_in_inv;\n");
-    fprintf(stdout, "\n");
-    fprintf(stdout, "    -- output reverse\n");
-    fprintf(stdout, "    gen_crc_out_inv: for ii in 0 to OUTPUT_WIDTH-1 generate\n");
-    fprintf(stdout, "        crc_out_inv(ii) <= lfsr_q(OUTPUT_WIDTH-ii-1);\n");
-    fprintf(stdout, "    end generate gen_crc_out_inv;\n");
-    fprintf(stdout, "\n");
-    fprintf(stdout, "    -- input reverse\n");
-    fprintf(stdout, "    data_in_inv_res <= data_in_inv when INPUT_INV = '1' else data_in;\n");
-    fprintf(stdout, "    -- output reverse\n");
-    fprintf(stdout, "    crc_out_inv_res <= crc_out_inv when OUTPUT_INV = '1' else lfsr_q;\n");
-    fprintf(stdout, "    -- output xor\n");
-    fprintf(stdout, "    crc_out <= crc_out_inv_res xor OUTPUT_XOR;\n");
-
-    // print columns of LFSR[(N+M)xN] matrix
-    // go thru each column
-    for (n2 = 0; n2 < N; n2++)
-    {
-        fprintf(stdout, "\n    lfsr_c(%d) <= ", n2);
-        bool is_first = true;
-
-        for (n1 = 0; n1 < N; n1++)
-        {
-            if (lfsr_matrix[n1 * N + n2])
             {
-                if (is_first)
-                {
-                    fprintf(stdout, "lfsr_q(%d)", n1);
-
-                    is_first = false;
-                }
-                else
-                {
-                    fprintf(stdout, " xor lfsr_q(%d)", n1);
-                }
+                print_usage();
+                exit(1);
             }
         }
+        else if (!strcmp(argv[i], "--stream"))
+        {
+            job.streaming = true;
+        }
+        else if (!strcmp(argv[i], "--cse"))
+        {
+            job.use_cse = true;
+        }
+        else if (!strcmp(argv[i], "--lut6"))
+        {
+            job.lut6 = true;
+        }
+        else if (!strcmp(argv[i], "--byte-enables"))
+        {
+            job.byte_enables = true;
+        }
+        else if (!strcmp(argv[i], "--input-inv"))
+        {
+            job.input_inv = true;
+        }
+        else if (!strcmp(argv[i], "--output-inv"))
+        {
+            job.output_inv = true;
+        }
+        else if (!strcmp(argv[i], "--throughput"))
+        {
+            job.throughput = true;
+        }
+        else if (!strcmp(argv[i], "--selfcheck"))
+        {
+            job.selfcheck = true;
+        }
+        else if (!strcmp(argv[i], "--testbench"))
+        {
+            job.testbench = true;
+        }
+        else if (!strcmp(argv[i], "--stats"))
+        {
+            want_stats = true;
+        }
+        else if (!strcmp(argv[i], "--cache") || !strcmp(argv[i], "--export-matrix"))
+        {
+            if (i + 1 == argc)
+            {
+                print_usage();
+                exit(1);
+            }
 
-        for (m1 = 0; m1 < M; m1++)
+            if (argv[i][2] == 'c')
+                job.cache_dir = argv[++i];
+            else
+                job.export_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--stats-json"))
+        {
+            if (i + 1 == argc)
+            {
+                print_usage();
+                exit(1);
+            }
+
+            want_stats = true;
+            job.stats_json = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--vectors"))
+        {
+            job.vectors = i + 1 < argc ? atoll(argv[++i]) : 0;
+
+            if (job.vectors < 1)
+            {
+                print_usage();
+                exit(1);
+            }
+        }
+        else if (!strcmp(argv[i], "--init") || !strcmp(argv[i], "--output-xor"))
+        {
+            if (i + 1 == argc)
+            {
+                print_usage();
+                exit(1);
+            }
+
+            if (argv[i][2] == 'i')
+                job.init_str = argv[++i];
+            else
+                job.xorout_str = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-o") || !strcmp(argv[i], "--batch"))
         {
-            if (lfsr_matrix[N * N + m1 * N + n2])
+            if (i + 1 == argc)
             {
-                if (is_first)
-                {
-                    fprintf(stdout, "data_in_inv_res(%d)", m1);
-
-                    is_first = false;
-                }
-                else
-                {
-                    fprintf(stdout, " xor data_in_inv_res(%d)", m1);
-                }
+                print_usage();
+                exit(1);
             }
+
+            if (argv[i][1] == 'o')
+                job.out_path = argv[++i];
+            else
+                manifest_path = argv[++i];
         }
+        else if (!strcmp(argv[i], "--pipeline"))
+        {
+            job.pipeline_stages = i + 1 < argc ? atoi(argv[++i]) : 0;
+
+            if (job.pipeline_stages < 1 || job.pipeline_stages > 16)
+            {
+                print_usage();
+                exit(1);
+            }
+        }
+        else if (!strcmp(argv[i], "--scrambler") || !strcmp(argv[i], "--descrambler"))
+        {
+            const char *type = i + 1 < argc ? argv[i + 1] : "";
+
+            job.descramble = argv[i][2] == 'd';
+
+            if (!strcmp(type, "additive"))
+                job.scrambler = SCRAMBLER_ADDITIVE;
+            else if (!strcmp(type, "self-sync"))
+                job.scrambler = SCRAMBLER_SELF_SYNC;
+            else
+            {
+                print_usage();
+                exit(1);
+            }
 
-        fprintf(stdout, ";");
+            i++;
+        }
+        else if (!strcmp(argv[i], "--fold"))
+        {
+            job.fold = i + 1 < argc ? atoi(argv[++i]) : 0;
+
+            if (job.fold < 2)
+            {
+                print_usage();
+                exit(1);
+            }
+        }
+        else if (!strcmp(argv[i], "--serve"))
+        {
+            if (i + 1 == argc)
+            {
+                print_usage();
+                exit(1);
+            }
+
+            serve_path = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--lru-mb"))
+        {
+            lru_mb = i + 1 < argc ? atoi(argv[++i]) : 0;
+
+            if (lru_mb < 1)
+            {
+                print_usage();
+                exit(1);
+            }
+        }
+        else if (!strcmp(argv[i], "--max-weight"))
+        {
+            job.max_weight = i + 1 < argc ? atoi(argv[++i]) : 0;
+
+            if (job.max_weight < 2 || job.max_weight > HD_WEIGHT_MAX)
+            {
+                print_usage();
+                exit(1);
+            }
+        }
+        else if (!strcmp(argv[i], "--channels"))
+        {
+            job.channels = i + 1 < argc ? atoi(argv[++i]) : 0;
+
+            if (job.channels < 2 || job.channels > CRC_CHANNELS_MAX)
+            {
+                print_usage();
+                exit(1);
+            }
+        }
+        else if (!strcmp(argv[i], "--lanes"))
+        {
+            job.lanes = i + 1 < argc ? atoi(argv[++i]) : 0;
+
+            if (job.lanes < 2)
+            {
+                print_usage();
+                exit(1);
+            }
+        }
+        else if (!strncmp(argv[i], "-j", 2))
+        {
+            const char *val = argv[i][2] ? argv[i] + 2 : (i + 1 < argc ? argv[++i] : "");
+
+            job.num_threads = atoi(val);
+            want_threads = true;
+
+            if (job.num_threads < 0 || val[0] < '0' || val[0] > '9')
+            {
+                print_usage();
+                exit(1);
+            }
+
+            if (job.num_threads == 0)
+                job.num_threads = parallel_default_threads();
+        }
+        else if (argv[i][0] == '-' || pos_cnt == 4)
+        {
+            print_usage();
+            exit(1);
+        }
+        else
+        {
+            pos_args[pos_cnt++] = argv[i];
+        }
+    }
+
+    if (serve_path)
+    {
+        if (pos_cnt || job.out_path || job.streaming || job.use_cse || job.pipeline_stages || job.byte_enables || job.lanes || job.fold > 1 || job.lut6 ||
+            job.channels || job.scrambler || job.selfcheck || job.testbench || want_stats || job.export_path || job.throughput || manifest_path || job.max_weight)
+        {
+            fprintf(stderr, "\n\terror: --serve only takes -j, --cache and --lru-mb\n");
+            exit(1);
+        }
+
+        if (job.cache_dir && *job.cache_dir && !matrix_cache_mkdir(job.cache_dir))
+        {
+            fprintf(stderr, "\n\terror: cannot create cache directory %s\n", job.cache_dir);
+            exit(1);
+        }
+
+        matrix_lru lru;
+
+        matrix_lru_init(&lru, (size_t)(lru_mb ? lru_mb : SERVER_LRU_MB) << 20);
+
+        int num_threads = want_threads ? job.num_threads : parallel_default_threads();
+
+        // every request builds on its own worker thread
+        job.lru = &lru;
+        job.num_threads = 1;
+
+        if (job.cache_dir && !*job.cache_dir)
+            job.cache_dir = NULL;
+
+        return run_server(serve_path, num_threads, &lru, serve_request, &job);
+    }
+
+    if (lru_mb)
+    {
+        fprintf(stderr, "\n\terror: --lru-mb only applies to --serve\n");
+        exit(1);
+    }
+
+    if (pos_cnt == 4 && !strcmp(pos_args[0], "analyze"))
+    {
+        if (job.streaming || job.use_cse || job.pipeline_stages || job.byte_enables || job.lanes || job.fold > 1 || job.lut6 || job.channels || job.scrambler ||
+            job.selfcheck || job.testbench || want_stats || job.export_path || job.throughput || manifest_path)
+        {
+            fprintf(stderr, "\n\terror: analyze only takes -o, -j and --max-weight\n");
+            exit(1);
+        }
+
+        return run_analyze(&job, pos_args[1], pos_args[2], pos_args[3], want_threads ? job.num_threads : parallel_default_threads());
+    }
+
+    const char *err = check_job_options(&job, want_stats, manifest_path != NULL);
+
+    if (err)
+    {
+        fprintf(stderr, "\n\terror: %s\n", err);
+        exit(1);
     }
 
-    fprintf(stdout, "\n\n");
+    crc_stats stats;
+
+    if (want_stats)
+        job.stats = &stats;
 
-    fprintf(stdout, "    process (clk, rst) begin\n");
-    fprintf(stdout, "        if rst = '1' then\n");
-    fprintf(stdout, "            lfsr_q <= INIT;\n");
-    fprintf(stdout, "        elsif rising_edge(clk) then\n");
-    fprintf(stdout, "            if crc_en = '1' then\n");
-    fprintf(stdout, "                lfsr_q <= lfsr_c;\n");
-    fprintf(stdout, "            else\n");
-    fprintf(stdout, "                null;\n");
-    fprintf(stdout, "            end if;\n");
-    fprintf(stdout, "        end if;\n");
-    fprintf(stdout, "    end process;\n\n");
-    fprintf(stdout, "end architecture imp_crc; \n");
+    if (job.cache_dir && !*job.cache_dir)
+        job.cache_dir = NULL;
+
+    if (job.cache_dir && !matrix_cache_mkdir(job.cache_dir))
+    {
+        fprintf(stderr, "\n\terror: cannot create cache directory %s\n", job.cache_dir);
+        exit(1);
+    }
+
+    if (manifest_path)
+    {
+        if (job.throughput || job.stats)
+        {
+            fprintf(stderr, "\n\terror: --throughput and --stats can not be used with --batch\n");
+            exit(1);
+        }
+
+        if (pos_cnt)
+        {
+            print_usage();
+            exit(1);
+        }
+
+        return run_batch(manifest_path, &job);
+    }
 
-} // print_vhdl_crc
\ No newline at end of file
+    if (pos_cnt != 4)
+    {
+        print_usage();
+        exit(1);
+    }
+
+    if (job.testbench && !job.out_path)
+    {
+        fprintf(stderr, "\n\terror: --testbench needs an output file\n");
+        exit(1);
+    }
+
+    err = parse_crc_params(&job, pos_args[0], pos_args[1], pos_args[2], pos_args[3]);
+
+    if (err)
+    {
+        if (!strcmp(err, "invalid language"))
+            print_usage();
+        else
+            fprintf(stderr, "\n\terror: %s\n", err);
+        exit(1);
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    gf2_word *lfsr_poly = (gf2_word *)calloc(GF2_WORDS(job.poly_width), sizeof(gf2_word));
+
+    if (!lfsr_poly)
+    {
+        fprintf(stderr, "\n\terror: failed mem allocation\n");
+        exit(1);
+    }
+
+    if (!parse_poly_string(job.poly_str, job.poly_width, lfsr_poly))
+    {
+        free(lfsr_poly);
+        fprintf(stderr, "\n\terror: invalid poly string \n");
+        exit(1);
+    }
+
+    if (job.stats)
+    {
+        crc_stats_init(job.stats, job.poly_width, job.data_width / job.fold);
+        job.stats->parse_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    bool ok = generate_crc(&job, lfsr_poly, NULL);
+
+    free(lfsr_poly);
+
+    return ok ? 0 : 1;
+}
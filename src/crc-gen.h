@@ -0,0 +1,148 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CRC_GEN_H
+#define CRC_GEN_H
+
+#include "emit.h"
+#include "gf2.h"
+#include "lanes.h"
+#include "lut6.h"
+#include "pipeline.h"
+
+//
+// library interface of crc-gen: the matrix builders (crc_build.cpp) and the
+// HDL printers (crc_print.cpp). crc-gen.cpp is the command line on top, the
+// runtime model of the core is in crc_model.h and the compile-time matrix in
+// crc_matrix.h.
+//
+
+//
+// the CRC equations are kept as a bit-packed GF(2) matrix with one row per
+// output bit lfsr_c[n2] and N+M columns: columns 0..N-1 select lfsr_q[n1],
+// columns N..N+M-1 select data_in_inv_res[m1].
+//
+
+//
+// the equations as seen by the printers: either the fully built matrix, or in
+// streaming mode a window of CRC_STREAM_ROWS rows that is recomputed on
+// demand, so memory stays O(N+M) bits however wide the CRC gets.
+//
+#define CRC_STREAM_ROWS 64
+
+struct crc_equations
+{
+    int lfsr_poly_size;
+    int num_data_bits;
+    const gf2_word *lfsr_poly;
+    bool streaming;
+    int first_row; // equation held in rows[0]
+    gf2_matrix rows;
+
+    // shared XOR terms from xor_cse(), column N+M+k of the rows is the term
+    // xor_shared[k] = column shared_pairs[2k] ^ column shared_pairs[2k+1]
+    int num_shared;
+    const int *shared_pairs;
+
+    // data terms precomputed in register stages, NULL for a single cycle core
+    const crc_pipeline *pipeline;
+
+    // equation sets for partial beats of 1..M/8-1 bytes, keep_rows[b] is the
+    // matrix of a (b+1)*8 bit wide beat, see emit_equations
+    int num_keep_sets;
+    const gf2_matrix *keep_rows;
+
+    // split-and-combine data path, NULL for the flat equations. rows are then
+    // the combine equations, column N+M+l*N+i is lane_crc<l>[i]
+    const crc_lanes *lanes;
+
+    // clocks per data_in beat, the rows take one num_data_bits wide slice
+    // data_slice of it a clock, see fold.h. 1 for a fully parallel core
+    int fold;
+
+    // LUT6 mapped XOR groups, NULL for the flat equations. rows are then the
+    // top level, column N+M+k is group k, see lut6.h
+    const crc_lut6 *lut6;
+};
+
+const gf2_word *crc_equation(crc_equations *lfsr_eq, int n2);
+
+void emit_crc_term(emit_buf *out, const crc_equations *lfsr_eq, int t, bool is_vhdl);
+
+void emit_pipeline_node(emit_buf *out, const crc_pipeline *pipe, int stage, int node, bool is_vhdl);
+
+void emit_equations(emit_buf *out,
+                    crc_equations *lfsr_eq,
+                    const gf2_matrix *rows,
+                    int data_offset,
+                    const char *name,
+                    bool is_vhdl);
+
+void print_verilog_crc(emit_buf *out,
+                       int lfsr_poly_size,
+                       int num_data_bits,
+                       const gf2_word *lfsr_poly,
+                       crc_equations *lfsr_eq);
+
+void print_vhdl_crc(emit_buf *out,
+                    int lfsr_poly_size,
+                    int num_data_bits,
+                    const gf2_word *lfsr_poly,
+                    crc_equations *lfsr_eq);
+
+void build_crc_matrix(int lfsr_poly_size,
+                      const gf2_word *lfsr_poly,
+                      int num_data_bits,
+                      gf2_matrix *lfsr_matrix,
+                      int num_threads);
+
+bool build_crc_matrix_fast(int lfsr_poly_size,
+                           const gf2_word *lfsr_poly,
+                           int num_data_bits,
+                           gf2_matrix *lfsr_matrix,
+                           int first_row,
+                           const gf2_matrix *chain);
+
+void build_crc_chain(int lfsr_poly_size,
+                     const gf2_word *lfsr_poly,
+                     gf2_matrix *chain);
+
+// the serial reference: shift num_bits_to_shift bits of data_cur, bit 0
+// first, through the LFSR
+void lfsr_serial_shift_crc(int num_bits_to_shift,
+                           int lfsr_poly_size,
+                           const gf2_word *lfsr_poly,
+                           const gf2_word *lfsr_cur,
+                           gf2_word *lfsr_next,
+                           int num_data_bits,
+                           const gf2_word *data_cur);
+
+// hex string to the poly_width lowest bits of lfsr_poly, which must be zeroed
+bool parse_poly_string(const char *poly_str, int poly_width, gf2_word *lfsr_poly);
+
+#endif // CRC_GEN_H
@@ -0,0 +1,279 @@
+/*
+The MIT License
+
+Copyright (c) 2009 OutputLogic.com, Evgeni Stavinov
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "crc-gen.h"
+#include "gf2.h"
+#include "parallel.h"
+
+//
+// hex string to the poly_width lowest bits of lfsr_poly, which must be zeroed.
+// missing leading digits are taken as 0.
+//
+bool parse_poly_string(const char *poly_str, int poly_width, gf2_word *lfsr_poly)
+{
+    int poly_str_len = (int)strlen(poly_str);
+
+    for (int i = 0; i < poly_width; i++)
+    {
+        char cur_byte = i / 4 < poly_str_len ? poly_str[poly_str_len - 1 - i / 4] : '0';
+        char nibble;
+
+        if (cur_byte >= '0' && cur_byte <= '9')
+            nibble = cur_byte - '0';
+        else if (cur_byte >= 'a' && cur_byte <= 'f')
+            nibble = 10 + cur_byte - 'a';
+        else if (cur_byte >= 'A' && cur_byte <= 'F')
+            nibble = 10 + cur_byte - 'A';
+        else
+            return false;
+
+        if (1 & (nibble >> (i % 4)))
+            gf2_set(lfsr_poly, i);
+    }
+
+    return true;
+}
+
+//
+// The N state columns and M data columns are independent serial simulations,
+// so they are split across num_threads workers. A work item is a block of 64
+// matrix columns: each block owns one word of every row, which keeps the
+// scatter into the rows free of races without any locking.
+//
+void build_crc_matrix(int lfsr_poly_size,
+                      const gf2_word *lfsr_poly,
+                      int num_data_bits,
+                      gf2_matrix *lfsr_matrix,
+                      int num_threads)
+{
+    int N = lfsr_poly_size;
+    int M = num_data_bits;
+
+    if (num_threads < 1)
+        num_threads = 1;
+
+    // per-thread scratch
+    std::vector<gf2_word> scratch((size_t)num_threads * (2 * GF2_WORDS(N) + GF2_WORDS(M)));
+
+    parallel_for(lfsr_matrix->words, num_threads, [&](int block, int thread)
+                 {
+                     gf2_word *lfsr_cur = &scratch[(size_t)thread * (2 * GF2_WORDS(N) + GF2_WORDS(M))];
+                     gf2_word *lfsr_next = lfsr_cur + GF2_WORDS(N);
+                     gf2_word *data_cur = lfsr_next + GF2_WORDS(N);
+
+                     int col_end = (block + 1) * GF2_WORD_BITS;
+
+                     if (col_end > N + M)
+                         col_end = N + M;
+
+                     for (int col = block * GF2_WORD_BITS; col < col_end; col++)
+                     {
+                         gf2_vec_zero(lfsr_cur, GF2_WORDS(N));
+                         gf2_vec_zero(data_cur, GF2_WORDS(M));
+
+                         if (col < N)
+                         {
+                             // LFSR-2-LFSR matrix[NxN], data_cur=0
+                             gf2_set(lfsr_cur, col);
+                         }
+                         else
+                         {
+                             // Data-2-LFSR matrix[MxN], lfsr_cur=0
+                             // Invert CRC data bits
+                             gf2_set(data_cur, M - 1 - (col - N));
+                         }
+
+                         lfsr_serial_shift_crc(M,
+                                               N,
+                                               lfsr_poly,
+                                               lfsr_cur,
+                                               lfsr_next,
+                                               M,
+                                               data_cur);
+
+                         for (int n2 = gf2_next_set(lfsr_next, GF2_WORDS(N), 0); n2 >= 0; n2 = gf2_next_set(lfsr_next, GF2_WORDS(N), n2 + 1))
+                             gf2_set(gf2_row(lfsr_matrix, n2), col);
+                     }
+                 });
+
+} // build_matrices_crc
+
+//
+// Same matrix as build_crc_matrix, derived from the linearity of the LFSR.
+//
+// One shift with zero data is x' = A*x, and a data bit injected at shift j
+// adds the feedback vector f = poly|1 to the state, which then gets shifted
+// another M-1-j times. So with v[k] = A^k * f:
+//   data column for data bit m1 (stored inverted at M-1-m1) = v[M-1-m1]
+//   state column n1 = A^M * e[n1] = e[n1+M]            if n1+M < N
+//                                 = v[M-(N-n1)]        otherwise
+// since A*e[i] = e[i+1] for i < N-1 and A*e[N-1] = f.
+// Each v[k+1] is a single shift of v[k], so the build is O((N+M)*N/64).
+//
+// lfsr_matrix may hold only a window of the full matrix: its rows are the
+// equations first_row..first_row+lfsr_matrix->rows-1, the rest are skipped.
+// if chain is given, v[k] is read from its row k instead of being shifted.
+// returns false on failed allocation.
+//
+bool build_crc_matrix_fast(int lfsr_poly_size,
+                           const gf2_word *lfsr_poly,
+                           int num_data_bits,
+                           gf2_matrix *lfsr_matrix,
+                           int first_row,
+                           const gf2_matrix *chain)
+{
+    int N = lfsr_poly_size;
+    int M = num_data_bits;
+    int words = GF2_WORDS(N);
+    int row_end = first_row + lfsr_matrix->rows;
+    int k, n1, n2;
+
+    gf2_word data_zero = 0;
+    gf2_word *v = (gf2_word *)calloc(words, sizeof(gf2_word));
+
+    if (!v)
+        return false;
+
+    // v[0] = f
+    gf2_vec_copy(v, lfsr_poly, words);
+    v[0] |= 1;
+
+    for (k = 0; k < M; k++)
+    {
+        const gf2_word *vk = chain ? gf2_row(chain, k) : v;
+
+        // data column M-1-m1 = v[k], state column n1 with M-(N-n1) = k
+        n1 = k - M + N;
+
+        for (n2 = gf2_next_set(vk, words, first_row); n2 >= 0 && n2 < row_end; n2 = gf2_next_set(vk, words, n2 + 1))
+        {
+            gf2_set(gf2_row(lfsr_matrix, n2 - first_row), N + k);
+
+            if (n1 >= 0)
+                gf2_set(gf2_row(lfsr_matrix, n2 - first_row), n1);
+        }
+
+        if (chain)
+            continue;
+
+        // v[k+1] = A * v[k]
+        lfsr_serial_shift_crc(1,
+                              N,
+                              lfsr_poly,
+                              v,
+                              v,
+                              1,
+                              &data_zero);
+    }
+
+    // state bits that are only moved up, never reach the feedback
+    for (n1 = 0; n1 + M < N; n1++)
+    {
+        if (n1 + M >= first_row && n1 + M < row_end)
+            gf2_set(gf2_row(lfsr_matrix, n1 + M - first_row), n1);
+    }
+
+    free(v);
+
+    return true;
+
+} // build_crc_matrix_fast
+
+//
+// v[k] = A^k * f for k = 0..chain->rows-1 into the rows of chain. The sequence
+// only depends on the polynomial, so it serves every data width up to
+// chain->rows through build_crc_matrix_fast.
+//
+void build_crc_chain(int lfsr_poly_size,
+                     const gf2_word *lfsr_poly,
+                     gf2_matrix *chain)
+{
+    gf2_word data_zero = 0;
+    gf2_word *v = gf2_row(chain, 0);
+
+    gf2_vec_copy(v, lfsr_poly, chain->words);
+    v[0] |= 1;
+
+    for (int k = 1; k < chain->rows; k++)
+    {
+        lfsr_serial_shift_crc(1,
+                              lfsr_poly_size,
+                              lfsr_poly,
+                              gf2_row(chain, k - 1),
+                              gf2_row(chain, k),
+                              1,
+                              &data_zero);
+    }
+
+} // build_crc_chain
+
+//
+// Serially shift {data_in,lfsr_cur} N times to get {lfsr_next}
+//
+void lfsr_serial_shift_crc(int num_bits_to_shift,
+                           int lfsr_poly_size,
+                           const gf2_word *lfsr_poly,
+                           const gf2_word *lfsr_cur,
+                           gf2_word *lfsr_next,
+                           int num_data_bits,
+                           const gf2_word *data_cur)
+{
+    int j;
+    int words = GF2_WORDS(lfsr_poly_size);
+
+    if (num_bits_to_shift > num_data_bits)
+    {
+        fprintf(stderr, "error: [%d] > [%d]\n", num_bits_to_shift, num_data_bits);
+        return;
+    }
+
+    if (lfsr_next != lfsr_cur)
+        gf2_vec_copy(lfsr_next, lfsr_cur, words);
+
+    for (j = 0; j < num_bits_to_shift; j++)
+    {
+        // shift the entire LFSR, feed back into the taps and bit 0
+        int lfsr_feedback = gf2_get(lfsr_next, lfsr_poly_size - 1) ^ gf2_get(data_cur, j);
+
+        gf2_vec_shl1(lfsr_next, lfsr_poly_size);
+
+        if (lfsr_feedback)
+        {
+            gf2_vec_xor(lfsr_next, lfsr_poly, words);
+            lfsr_next[0] |= 1;
+        }
+    }
+
+} // lfsr_serial_shift
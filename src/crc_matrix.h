@@ -0,0 +1,125 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CRC_MATRIX_H
+#define CRC_MATRIX_H
+
+#include <stdint.h>
+
+//
+// compile-time equations, header only and without the rest of the library
+//
+//     constexpr crc_matrix<32, 64, 0x04C11DB7> crc32_x64;
+//     lfsr_c = crc32_x64.step(lfsr_q, data_in_inv_res);
+//
+// the same matrix as build_crc_matrix_fast (see crc_build.cpp) for widths up
+// to 64, held as columns: state_cols[n1] is the lfsr_c pattern of lfsr_q[n1]
+// and data_cols[m1] the one of data_in_inv_res[m1], data_in_inv_res[M-1]
+// entering the LFSR first. data vectors are 64-bit words with bit m1 in word
+// m1/64, as gf2_word vectors.
+//
+// with v[k] = A^k * f:
+//   data_cols[m1]  = v[m1]
+//   state_cols[n1] = e[n1+M] if n1+M < N, else v[M-(N-n1)]
+//
+template <int PolyWidth, int DataWidth, uint64_t Poly>
+struct crc_matrix
+{
+    static_assert(PolyWidth >= 1 && PolyWidth <= 64, "crc_matrix: poly width 1..64");
+    static_assert(DataWidth >= 1, "crc_matrix: data width must be positive");
+    static_assert(PolyWidth == 64 || (Poly >> (PolyWidth % 64)) == 0, "crc_matrix: poly wider than PolyWidth");
+
+    static constexpr int N = PolyWidth;
+    static constexpr int M = DataWidth;
+    static constexpr int data_words = (DataWidth + 63) / 64;
+    static constexpr uint64_t mask = N == 64 ? ~(uint64_t)0 : ((uint64_t)1 << (N % 64)) - 1;
+    static constexpr uint64_t f = Poly | 1;
+
+    uint64_t state_cols[N];
+    uint64_t data_cols[M];
+
+    constexpr crc_matrix() : state_cols(), data_cols()
+    {
+        uint64_t v = f & mask;
+
+        for (int k = 0; k < M; k++)
+        {
+            data_cols[k] = v;
+
+            if (k - M + N >= 0)
+                state_cols[k - M + N] = v;
+
+            v = ((v << 1) & mask) ^ ((v >> (N - 1)) & 1 ? f & mask : 0);
+        }
+
+        for (int n1 = 0; n1 + M < N; n1++)
+            state_cols[n1] = (uint64_t)1 << (n1 + M);
+    }
+
+    // lfsr_c for one beat, data_in_inv_res holds data_words words
+    constexpr uint64_t step(uint64_t lfsr_q, const uint64_t *data_in_inv_res) const
+    {
+        uint64_t c = 0;
+
+        for (int n1 = 0; n1 < N; n1++)
+            c ^= state_cols[n1] & (0 - ((lfsr_q >> n1) & 1));
+
+        for (int m1 = 0; m1 < M; m1++)
+            c ^= data_cols[m1] & (0 - ((data_in_inv_res[m1 / 64] >> (m1 % 64)) & 1));
+
+        return c;
+    }
+
+    // data widths up to 64 in a single word
+    constexpr uint64_t step(uint64_t lfsr_q, uint64_t data_in_inv_res) const
+    {
+        static_assert(M <= 64, "crc_matrix: data wider than a word, use the array step");
+
+        return step(lfsr_q, &data_in_inv_res);
+    }
+
+    // whether lfsr_c[n2] has the term of column t, numbered as in crc-gen.h:
+    // t < N is lfsr_q[t], otherwise data_in_inv_res[t-N]
+    constexpr bool term(int n2, int t) const
+    {
+        return ((t < N ? state_cols[t] : data_cols[t - N]) >> n2) & 1;
+    }
+
+    // number of terms of lfsr_c[n2]
+    constexpr int terms(int n2) const
+    {
+        int n = 0;
+
+        for (int t = 0; t < N + M; t++)
+            n += term(n2, t);
+
+        return n;
+    }
+};
+
+#endif // CRC_MATRIX_H
@@ -0,0 +1,173 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "crc-gen.h"
+#include "crc_model.h"
+#include "gf2.h"
+
+bool crc_model_init(crc_model *m, int poly_width, const char *poly_str, int data_width)
+{
+    int N = poly_width;
+    int M = data_width;
+    int words = GF2_WORDS(N);
+
+    memset(m, 0, sizeof(*m));
+
+    if (N < 1 || M < 1)
+        return false;
+
+    m->lfsr_poly_size = N;
+    m->num_data_bits = M;
+    m->lfsr_poly = (gf2_word *)calloc(3 * words, sizeof(gf2_word));
+
+    if (!m->lfsr_poly || !parse_poly_string(poly_str, N, m->lfsr_poly) ||
+        !gf2_matrix_alloc(&m->rows, N, N + M) || !gf2_matrix_alloc(&m->cols, N + M, N))
+    {
+        crc_model_free(m);
+        return false;
+    }
+
+    m->init = m->lfsr_poly + words;
+    m->xorout = m->init + words;
+
+    for (int n = 0; n < N; n++)
+        gf2_set(m->init, n);
+
+    if (!build_crc_matrix_fast(N, m->lfsr_poly, M, &m->rows, 0, NULL))
+    {
+        crc_model_free(m);
+        return false;
+    }
+
+    for (int n2 = 0; n2 < N; n2++)
+    {
+        for (int t = crc_model_next_term(m, n2, 0); t >= 0; t = crc_model_next_term(m, n2, t + 1))
+            gf2_set(gf2_row(&m->cols, t), n2);
+    }
+
+    return true;
+}
+
+void crc_model_free(crc_model *m)
+{
+    free(m->lfsr_poly);
+    gf2_matrix_free(&m->rows);
+    gf2_matrix_free(&m->cols);
+    memset(m, 0, sizeof(*m));
+}
+
+bool crc_model_set_generics(crc_model *m,
+                            const char *init_str,
+                            const char *xorout_str,
+                            bool input_inv,
+                            bool output_inv)
+{
+    int N = m->lfsr_poly_size;
+    int words = GF2_WORDS(N);
+    gf2_word *value = (gf2_word *)calloc(2 * words, sizeof(gf2_word));
+
+    if (!value)
+        return false;
+
+    bool ok = (!init_str || parse_poly_string(init_str, N, value)) &&
+              (!xorout_str || parse_poly_string(xorout_str, N, value + words));
+
+    if (ok)
+    {
+        if (init_str)
+            gf2_vec_copy(m->init, value, words);
+        if (xorout_str)
+            gf2_vec_copy(m->xorout, value + words, words);
+        m->input_inv = input_inv;
+        m->output_inv = output_inv;
+    }
+
+    free(value);
+
+    return ok;
+}
+
+void crc_model_reset(const crc_model *m, gf2_word *lfsr_q)
+{
+    gf2_vec_copy(lfsr_q, m->init, GF2_WORDS(m->lfsr_poly_size));
+}
+
+void crc_model_step(const crc_model *m, const gf2_word *lfsr_q, const gf2_word *data_in, gf2_word *lfsr_c)
+{
+    int N = m->lfsr_poly_size;
+    int M = m->num_data_bits;
+    int words = GF2_WORDS(N);
+
+    gf2_vec_zero(lfsr_c, words);
+
+    for (int n1 = gf2_next_set(lfsr_q, words, 0); n1 >= 0; n1 = gf2_next_set(lfsr_q, words, n1 + 1))
+        gf2_vec_xor(lfsr_c, gf2_row(&m->cols, n1), words);
+
+    // data_in[m1] is data_in_inv_res[M-1-m1] with INPUT_INV
+    for (int m1 = gf2_next_set(data_in, GF2_WORDS(M), 0); m1 >= 0; m1 = gf2_next_set(data_in, GF2_WORDS(M), m1 + 1))
+        gf2_vec_xor(lfsr_c, gf2_row(&m->cols, N + (m->input_inv ? M - 1 - m1 : m1)), words);
+}
+
+void crc_model_output(const crc_model *m, const gf2_word *lfsr_q, gf2_word *crc_out)
+{
+    int N = m->lfsr_poly_size;
+    int words = GF2_WORDS(N);
+
+    gf2_vec_copy(crc_out, m->xorout, words);
+
+    for (int n = gf2_next_set(lfsr_q, words, 0); n >= 0; n = gf2_next_set(lfsr_q, words, n + 1))
+        gf2_flip(crc_out, m->output_inv ? N - 1 - n : n);
+}
+
+bool crc_model_compute(const crc_model *m, const gf2_word *data, int beats, gf2_word *crc_out)
+{
+    int words = GF2_WORDS(m->lfsr_poly_size);
+    gf2_word *state = (gf2_word *)calloc(2 * words, sizeof(gf2_word));
+
+    if (!state)
+        return false;
+
+    crc_model_reset(m, state);
+
+    for (int b = 0; b < beats; b++)
+    {
+        gf2_word *q = state + (b & 1) * words;
+        gf2_word *c = state + (~b & 1) * words;
+
+        crc_model_step(m, q, data + (size_t)b * GF2_WORDS(m->num_data_bits), c);
+    }
+
+    crc_model_output(m, state + (beats & 1) * words, crc_out);
+
+    free(state);
+
+    return true;
+}
@@ -0,0 +1,100 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CRC_MODEL_H
+#define CRC_MODEL_H
+
+#include "gf2.h"
+
+//
+// runtime API of the library: the parallel update of the generated core for
+// C++ models of the datapath
+//
+// a model holds the equations of one polynomial and data width twice: as
+// rows, one per lfsr_c[n2] with the columns of crc-gen.h, for walking the
+// terms the way the printers do, and as columns, one per input bit, so a
+// beat is lfsr_c = XOR of the columns of the set bits of {data_in_inv_res,
+// lfsr_q}. the generics have the meaning of the HDL parameters.
+//
+struct crc_model
+{
+    int lfsr_poly_size;
+    int num_data_bits;
+    gf2_word *lfsr_poly;
+
+    // INIT, OUTPUT_XOR, INPUT_INV and OUTPUT_INV
+    gf2_word *init;
+    gf2_word *xorout;
+    bool input_inv;
+    bool output_inv;
+
+    gf2_matrix rows; // N x (N+M)
+    gf2_matrix cols; // (N+M) x N, cols row c = rows column c
+};
+
+// poly_str is the hex polynomial of the command line, the generics start at
+// their HDL defaults. returns false on a bad poly string or failed allocation
+bool crc_model_init(crc_model *m, int poly_width, const char *poly_str, int data_width);
+void crc_model_free(crc_model *m);
+
+// hex strings, NULL keeps the value. returns false on a bad string
+bool crc_model_set_generics(crc_model *m,
+                            const char *init_str,
+                            const char *xorout_str,
+                            bool input_inv,
+                            bool output_inv);
+
+//
+// terms of lfsr_c[n2]: the first one at or after 'from', -1 if there is none.
+// term t < N is lfsr_q[t], otherwise data_in_inv_res[t-N]
+//
+// usage:
+//     for (int t = crc_model_next_term(m, n2, 0); t >= 0; t = crc_model_next_term(m, n2, t + 1))
+//
+static inline int crc_model_next_term(const crc_model *m, int n2, int from)
+{
+    return gf2_next_set(gf2_row(&m->rows, n2), m->rows.words, from);
+}
+
+// all vectors are N bits wide except data_in, which is M bits wide
+
+// lfsr_q after reset
+void crc_model_reset(const crc_model *m, gf2_word *lfsr_q);
+
+// one beat with crc_en high, data_in as seen on the port. lfsr_c must not
+// overlap lfsr_q
+void crc_model_step(const crc_model *m, const gf2_word *lfsr_q, const gf2_word *data_in, gf2_word *lfsr_c);
+
+// crc_out for the state lfsr_q
+void crc_model_output(const crc_model *m, const gf2_word *lfsr_q, gf2_word *crc_out);
+
+// crc_out after reset and 'beats' beats, beat b at data + b * GF2_WORDS(M),
+// false on failed allocation
+bool crc_model_compute(const crc_model *m, const gf2_word *data, int beats, gf2_word *crc_out);
+
+#endif // CRC_MODEL_H
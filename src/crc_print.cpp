@@ -0,0 +1,963 @@
+/*
+The MIT License
+
+Copyright (c) 2009 OutputLogic.com, Evgeni Stavinov
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "crc-gen.h"
+#include "emit.h"
+#include "fold.h"
+#include "gf2.h"
+#include "pipeline.h"
+
+//
+// equation row n2, in streaming mode the window of rows around n2 is rebuilt
+// when n2 falls outside of it. The printers walk n2 upwards, so each window
+// is built once: N/64 passes of the fast builder in total. NULL if the
+// window can not be built.
+//
+const gf2_word *crc_equation(crc_equations *lfsr_eq, int n2)
+{
+    gf2_matrix *rows = &lfsr_eq->rows;
+
+    if (lfsr_eq->streaming && (n2 < lfsr_eq->first_row || n2 >= lfsr_eq->first_row + rows->rows))
+    {
+        lfsr_eq->first_row = n2 - n2 % CRC_STREAM_ROWS;
+        rows->rows = lfsr_eq->lfsr_poly_size - lfsr_eq->first_row;
+
+        if (rows->rows > CRC_STREAM_ROWS)
+            rows->rows = CRC_STREAM_ROWS;
+
+        gf2_vec_zero(rows->bits, rows->rows * rows->words);
+
+        if (!build_crc_matrix_fast(lfsr_eq->lfsr_poly_size,
+                                   lfsr_eq->lfsr_poly,
+                                   lfsr_eq->num_data_bits,
+                                   rows,
+                                   lfsr_eq->first_row,
+                                   NULL))
+        {
+            rows->rows = 0;
+            return NULL;
+        }
+    }
+
+    return gf2_row(rows, n2 - lfsr_eq->first_row);
+
+} // crc_equation
+
+//
+// name of equation input t, t < N is lfsr_q, t < N+M data_in_inv_res or
+// data_slice of a folded core, the rest are the shared XOR terms, the lane
+// CRCs or the LUT6 groups
+//
+void emit_crc_term(emit_buf *out, const crc_equations *lfsr_eq, int t, bool is_vhdl)
+{
+    int N = lfsr_eq->lfsr_poly_size;
+    int M = lfsr_eq->num_data_bits;
+
+    if (t < N)
+    {
+        EMIT_LIT(out, "lfsr_q");
+    }
+    else if (t < N + M)
+    {
+        if (lfsr_eq->fold > 1)
+            EMIT_LIT(out, "data_slice");
+        else
+            EMIT_LIT(out, "data_in_inv_res");
+        t -= N;
+    }
+    else if (lfsr_eq->lanes)
+    {
+        EMIT_LIT(out, "lane_crc");
+        emit_int(out, (t - N - M) / N);
+        t = (t - N - M) % N;
+    }
+    else if (lfsr_eq->lut6)
+    {
+        const std::vector<int> &start = lfsr_eq->lut6->level_start;
+        int l = 0;
+
+        t -= N + M;
+
+        while (t >= start[l + 1])
+            l++;
+
+        EMIT_LIT(out, "lut6_l");
+        emit_int(out, l + 1);
+        t -= start[l];
+    }
+    else
+    {
+        EMIT_LIT(out, "xor_shared");
+        t -= N + M;
+    }
+
+    emit_mem(out, is_vhdl ? "(" : "[", 1);
+    emit_int(out, t);
+    emit_mem(out, is_vhdl ? ")" : "]", 1);
+
+} // emit_crc_term
+
+//
+// XOR of the inputs of one pipeline register
+//
+void emit_pipeline_node(emit_buf *out, const crc_pipeline *pipe, int stage, int node, bool is_vhdl)
+{
+    const std::vector<int> &in = pipe->nodes[stage][node];
+
+    if (in.empty())
+    {
+        if (is_vhdl)
+            EMIT_LIT(out, "'0'");
+        else
+            EMIT_LIT(out, "1'b0");
+        return;
+    }
+
+    for (size_t i = 0; i < in.size(); i++)
+    {
+        if (i)
+        {
+            if (is_vhdl)
+                EMIT_LIT(out, " xor ");
+            else
+                EMIT_LIT(out, " ^ ");
+        }
+
+        if (stage)
+        {
+            EMIT_LIT(out, "data_p");
+            emit_int(out, stage);
+        }
+        else
+        {
+            EMIT_LIT(out, "data_in_inv_res");
+        }
+
+        emit_mem(out, is_vhdl ? "(" : "[", 1);
+        emit_int(out, in[i]);
+        emit_mem(out, is_vhdl ? ")" : "]", 1);
+    }
+
+} // emit_pipeline_node
+
+//
+// the LUT6 groups level by level, one line per group:
+// "assign lut6_l<l>[i] = terms;" in verilog, "lut6_l<l>(i) <= terms;" in vhdl
+//
+static void emit_lut6_groups(emit_buf *out, const crc_equations *lfsr_eq, bool is_vhdl)
+{
+    const crc_lut6 *lut = lfsr_eq->lut6;
+    int base = lfsr_eq->lfsr_poly_size + lfsr_eq->num_data_bits;
+
+    if (is_vhdl)
+        EMIT_LIT(out, "\n    -- LUT6 groups, level by level\n");
+    else
+        EMIT_LIT(out, "    // LUT6 groups, level by level\n");
+
+    for (int k = 0; k < (int)lut->inputs.size(); k++)
+    {
+        const std::vector<int> &in = lut->inputs[k];
+
+        if (is_vhdl)
+            EMIT_LIT(out, "    ");
+        else
+            EMIT_LIT(out, "    assign ");
+
+        emit_crc_term(out, lfsr_eq, base + k, is_vhdl);
+
+        if (is_vhdl)
+            EMIT_LIT(out, " <= ");
+        else
+            EMIT_LIT(out, " = ");
+
+        for (size_t i = 0; i < in.size(); i++)
+        {
+            if (i)
+            {
+                if (is_vhdl)
+                    EMIT_LIT(out, " xor ");
+                else
+                    EMIT_LIT(out, " ^ ");
+            }
+
+            emit_crc_term(out, lfsr_eq, in[i], is_vhdl);
+        }
+
+        EMIT_LIT(out, ";\n");
+    }
+
+    if (!is_vhdl)
+        EMIT_LIT(out, "\n");
+
+} // emit_lut6_groups
+
+//
+// print rows of the LFSR[Nx(N+M)] equation matrix, one line per lfsr_c bit:
+// "name[n2] = terms;" in verilog, "name(n2) <= terms;" in vhdl.
+// rows NULL prints the equations of lfsr_eq, otherwise rows is the matrix of
+// a narrower beat whose data column j reads data_in_inv_res[data_offset+j]:
+// a partial beat of the first bits that are shifted in, or a lane. rows may
+// have other than N rows, as the outputs of a scrambler.
+//
+void emit_equations(emit_buf *out,
+                    crc_equations *lfsr_eq,
+                    const gf2_matrix *rows,
+                    int data_offset,
+                    const char *name,
+                    bool is_vhdl)
+{
+    int N = lfsr_eq->lfsr_poly_size;
+    int num_rows = rows ? rows->rows : N;
+    const crc_pipeline *pipe = lfsr_eq->pipeline;
+
+    // go thru each lfsr_c[n2]
+    for (int n2 = 0; n2 < num_rows; n2++)
+    {
+        if (is_vhdl)
+            EMIT_LIT(out, "\n    ");
+        else
+            EMIT_LIT(out, "\n        ");
+
+        emit_str(out, name);
+        emit_mem(out, is_vhdl ? "(" : "[", 1);
+        emit_int(out, n2);
+
+        if (is_vhdl)
+            EMIT_LIT(out, ") <= ");
+        else
+            EMIT_LIT(out, "] = ");
+
+        bool is_first = true;
+
+        const gf2_word *row = rows ? gf2_row(rows, n2) : crc_equation(lfsr_eq, n2);
+        int words = rows ? rows->words : lfsr_eq->rows.words;
+
+        // emit_close() reports it
+        if (!row)
+        {
+            out->failed = true;
+            return;
+        }
+
+        // visit only the set bits: lfsr_q terms, data terms, then shared terms
+        for (int t = gf2_next_set(row, words, 0); t >= 0; t = gf2_next_set(row, words, t + 1))
+        {
+            // pipelined data terms come in through the last stage
+            if (pipe && t >= N)
+                break;
+
+            if (!is_first)
+            {
+                if (is_vhdl)
+                    EMIT_LIT(out, " xor ");
+                else
+                    EMIT_LIT(out, " ^ ");
+            }
+
+            emit_crc_term(out, lfsr_eq, t < N ? t : t + data_offset, is_vhdl);
+            is_first = false;
+        }
+
+        if (pipe && !pipe->nodes[pipe->stages - 1][n2].empty())
+        {
+            if (!is_first)
+            {
+                if (is_vhdl)
+                    EMIT_LIT(out, " xor ");
+                else
+                    EMIT_LIT(out, " ^ ");
+            }
+
+            emit_fmt(out, is_vhdl ? "data_p%d(%d)" : "data_p%d[%d]", pipe->stages, n2);
+            is_first = false;
+        }
+
+        // a lane narrower than the CRC leaves some of its bits without terms
+        if (is_first)
+        {
+            if (is_vhdl)
+                EMIT_LIT(out, "'0'");
+            else
+                EMIT_LIT(out, "1'b0");
+        }
+
+        EMIT_LIT(out, ";");
+    }
+
+} // emit_equations
+
+//
+// generate verilog code for this CRC
+//
+void print_verilog_crc(emit_buf *out,
+                       int lfsr_poly_size,
+                       int num_data_bits,
+                       const gf2_word *lfsr_poly,
+                       crc_equations *lfsr_eq)
+{
+    EMIT_LIT(out, "\n//-----------------------------------------------------------------------------");
+    EMIT_LIT(out, "\n// Copyright (C) 2009 OutputLogic.com");
+    EMIT_LIT(out, "\n// This source file may be used and distributed without restriction");
+    EMIT_LIT(out, "\n// provided that this copyright statement is not removed from the file");
+    EMIT_LIT(out, "\n// and that any derivative work contains the original copyright notice");
+    EMIT_LIT(out, "\n// and the associated disclaimer.");
+    EMIT_LIT(out, "\n// THIS SOURCE FILE IS PROVIDED \"AS IS\" AND WITHOUT ANY EXPRESS");
+    EMIT_LIT(out, "\n// OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED	");
+    EMIT_LIT(out, "\n// WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.");
+    EMIT_LIT(out, "\n//-----------------------------------------------------------------------------\n");
+
+    const crc_pipeline *pipe = lfsr_eq->pipeline;
+    const crc_lanes *lanes = lfsr_eq->lanes;
+    int latency = pipe ? pipe->stages : (lanes ? 1 : 0); // the lane CRCs are registered
+    int fold = lfsr_eq->fold;
+    int num_bytes = lfsr_eq->num_keep_sets + 1;
+    char lfsr_c_name[32] = "lfsr_c";
+
+    // with byte enables the full beat is the last of the equation sets
+    if (lfsr_eq->keep_rows)
+        sprintf(lfsr_c_name, "lfsr_c_b%d", num_bytes);
+
+    EMIT_LIT(out, "// CRC module for\n");
+    emit_fmt(out, "//    data[%d:0]\n", num_data_bits - 1);
+    emit_fmt(out, "//    crc[%d:0]=", lfsr_poly_size - 1);
+
+    for (int l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), 0); l >= 0; l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), l + 1))
+    {
+        if (l)
+            emit_fmt(out, "+x^%d", l);
+        else
+            EMIT_LIT(out, "1");
+    }
+    emit_fmt(out, "+x^%d;\n\n", lfsr_poly_size);
+
+    EMIT_LIT(out, "\n");
+
+    EMIT_LIT(out, "module crc #(\n");
+    emit_fmt(out, "    parameter INPUT_WIDTH  = %d,\n", num_data_bits);
+    emit_fmt(out, "    parameter OUTPUT_WIDTH = %d,\n", lfsr_poly_size);
+    emit_fmt(out, "    parameter INIT         = {%d{1'b1}},\n",lfsr_poly_size);
+    emit_fmt(out, "    parameter OUTPUT_XOR   = {%d{1'b0}},\n",lfsr_poly_size);
+    EMIT_LIT(out, "    parameter INPUT_INV    = 1'b0,\n");
+    EMIT_LIT(out, "    parameter OUTPUT_INV   = 1'b0\n");
+    EMIT_LIT(out, ") (\n");
+    EMIT_LIT(out, "    input  wire [ (INPUT_WIDTH-1):0] data_in,\n");
+    EMIT_LIT(out, "    input  wire                      crc_en,\n");
+
+    if (lfsr_eq->keep_rows)
+        EMIT_LIT(out, "    input  wire [(INPUT_WIDTH/8-1):0] data_keep,\n");
+
+    EMIT_LIT(out, "    output wire [(OUTPUT_WIDTH-1):0] crc_out,\n");
+
+    if (latency)
+        EMIT_LIT(out, "    output reg                       crc_valid,\n");
+
+    if (fold > 1)
+        EMIT_LIT(out, "    output wire                      crc_ready,\n");
+
+    EMIT_LIT(out, "    input  wire                      rst,\n");
+    EMIT_LIT(out, "    input  wire                      clk\n");
+    EMIT_LIT(out, ");\n");
+
+    EMIT_LIT(out, "\n");
+
+    EMIT_LIT(out, "    genvar ii;\n");
+    EMIT_LIT(out, "    wire [ (INPUT_WIDTH-1):0] data_in_inv;\n");
+    EMIT_LIT(out, "    wire [ (INPUT_WIDTH-1):0] data_in_inv_res;\n");
+    EMIT_LIT(out, "    wire [(OUTPUT_WIDTH-1):0] crc_out_inv;\n");
+    EMIT_LIT(out, "    wire [(OUTPUT_WIDTH-1):0] crc_out_inv_res;\n");
+    EMIT_LIT(out, "    reg  [(OUTPUT_WIDTH-1):0] lfsr_q;\n");
+    EMIT_LIT(out, "    reg  [(OUTPUT_WIDTH-1):0] lfsr_c;\n");
+
+    if (lfsr_eq->num_shared)
+        emit_fmt(out, "    wire [%d:0] xor_shared;\n", lfsr_eq->num_shared - 1);
+
+    for (int l = 0; lanes && l < lanes->lanes; l++)
+    {
+        emit_fmt(out, "    reg  [(OUTPUT_WIDTH-1):0] lane_c%d;\n", l);
+        emit_fmt(out, "    reg  [(OUTPUT_WIDTH-1):0] lane_crc%d;\n", l);
+    }
+
+    for (int l = 0; lfsr_eq->lut6 && l + 1 < (int)lfsr_eq->lut6->level_start.size(); l++)
+    {
+        int n = lfsr_eq->lut6->level_start[l + 1] - lfsr_eq->lut6->level_start[l];
+
+        if (n)
+            emit_fmt(out, "    wire [%d:0] lut6_l%d;\n", n - 1, l + 1);
+    }
+
+    if (lfsr_eq->keep_rows)
+    {
+        for (int b = 1; b <= num_bytes; b++)
+            emit_fmt(out, "    reg  [(OUTPUT_WIDTH-1):0] lfsr_c_b%d;\n", b);
+    }
+
+    if (latency)
+    {
+        emit_fmt(out, "\n    // data_in to lfsr_q register stages\n    localparam LATENCY = %d;\n\n", latency);
+
+        for (int s = 0; pipe && s < pipe->stages; s++)
+            emit_fmt(out, "    reg  [%d:0] data_p%d;\n", (int)pipe->nodes[s].size() - 1, s + 1);
+
+        emit_fmt(out, "    reg  [%d:0] crc_en_p;\n", latency - 1);
+    }
+
+    if (fold > 1)
+    {
+        emit_fmt(out, "\n    // data_in beat taken over FOLD clocks, a slice per clock\n    localparam FOLD        = %d;\n", fold);
+        EMIT_LIT(out, "    localparam SLICE_WIDTH = INPUT_WIDTH/FOLD;\n\n");
+        EMIT_LIT(out, "    reg  [(INPUT_WIDTH-SLICE_WIDTH-1):0] data_sr;\n");
+        emit_fmt(out, "    reg  [%d:0] fold_cnt;\n", fold_counter_bits(fold) - 1);
+        EMIT_LIT(out, "    wire [(SLICE_WIDTH-1):0] data_slice;\n");
+    }
+
+    EMIT_LIT(out, "\n");
+
+    EMIT_LIT(out, "    generate\n");
+    EMIT_LIT(out, "        for (ii = 0; ii < INPUT_WIDTH; ii = ii + 1) begin\n");
+    EMIT_LIT(out, "            assign data_in_inv[ii] = data_in[INPUT_WIDTH-ii-1];\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "        for (ii = 0; ii < OUTPUT_WIDTH; ii = ii + 1) begin\n");
+    EMIT_LIT(out, "            assign crc_out_inv[ii] = lfsr_q[OUTPUT_WIDTH-ii-1];\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "    endgenerate\n");
+
+    EMIT_LIT(out, "\n");
+
+    EMIT_LIT(out, "    // input reverse\n");
+    EMIT_LIT(out, "    assign data_in_inv_res = (INPUT_INV == 1'b1) ? (data_in_inv) : data_in;\n");
+    EMIT_LIT(out, "    // output reverse\n");
+    EMIT_LIT(out, "    assign crc_out_inv_res = (OUTPUT_INV == 1'b1) ? (crc_out_inv) : lfsr_q;\n");
+    EMIT_LIT(out, "    // output xor\n");
+    EMIT_LIT(out, "    assign crc_out         = crc_out_inv_res ^ OUTPUT_XOR;\n");
+
+    EMIT_LIT(out, "\n");
+
+    if (lfsr_eq->num_shared)
+    {
+        EMIT_LIT(out, "    // shared XOR terms\n");
+
+        for (int k = 0; k < lfsr_eq->num_shared; k++)
+        {
+            EMIT_LIT(out, "    assign xor_shared[");
+            emit_int(out, k);
+            EMIT_LIT(out, "] = ");
+            emit_crc_term(out, lfsr_eq, lfsr_eq->shared_pairs[2 * k], false);
+            EMIT_LIT(out, " ^ ");
+            emit_crc_term(out, lfsr_eq, lfsr_eq->shared_pairs[2 * k + 1], false);
+            EMIT_LIT(out, ";\n");
+        }
+
+        EMIT_LIT(out, "\n");
+    }
+
+    if (lfsr_eq->lut6)
+        emit_lut6_groups(out, lfsr_eq, false);
+
+    if (pipe)
+    {
+        EMIT_LIT(out, "    // data terms, balanced XOR trees\n");
+        EMIT_LIT(out, "    always @(posedge clk) begin\n");
+
+        for (int s = 0; s < pipe->stages; s++)
+        {
+            for (int i = 0; i < (int)pipe->nodes[s].size(); i++)
+            {
+                EMIT_LIT(out, "        data_p");
+                emit_int(out, s + 1);
+                EMIT_LIT(out, "[");
+                emit_int(out, i);
+                EMIT_LIT(out, "] <= ");
+                emit_pipeline_node(out, pipe, s, i, false);
+                EMIT_LIT(out, ";\n");
+            }
+        }
+
+        EMIT_LIT(out, "    end // always\n\n");
+    }
+
+    if (latency)
+    {
+        EMIT_LIT(out, "    always @(posedge clk, posedge rst) begin\n");
+        EMIT_LIT(out, "        if (rst) begin\n");
+        emit_fmt(out, "            crc_en_p <= {%d{1'b0}};\n", latency);
+        EMIT_LIT(out, "        end else begin\n");
+
+        if (latency > 1)
+            emit_fmt(out, "            crc_en_p <= {crc_en_p[%d:0], crc_en};\n", latency - 2);
+        else
+            EMIT_LIT(out, "            crc_en_p <= crc_en;\n");
+
+        EMIT_LIT(out, "        end\n");
+        EMIT_LIT(out, "    end // always\n\n");
+    }
+
+    if (fold > 1)
+    {
+        EMIT_LIT(out, "    // the first slice comes straight from data_in, the rest from data_sr\n");
+        EMIT_LIT(out, "    assign crc_ready  = (fold_cnt == 0);\n");
+        EMIT_LIT(out, "    assign data_slice = crc_ready ? data_in_inv_res[(INPUT_WIDTH-1) -: SLICE_WIDTH] :\n");
+        EMIT_LIT(out, "                                    data_sr[(INPUT_WIDTH-SLICE_WIDTH-1) -: SLICE_WIDTH];\n\n");
+        EMIT_LIT(out, "    always @(posedge clk) begin\n");
+        EMIT_LIT(out, "        if (crc_ready)\n");
+        EMIT_LIT(out, "            data_sr <= data_in_inv_res[(INPUT_WIDTH-SLICE_WIDTH-1):0];\n");
+        EMIT_LIT(out, "        else\n");
+        EMIT_LIT(out, "            data_sr <= data_sr << SLICE_WIDTH;\n");
+        EMIT_LIT(out, "    end // always\n\n");
+    }
+
+    if (lfsr_eq->keep_rows)
+    {
+        EMIT_LIT(out, "    // partial beats: data_keep[i] marks byte i in shift order valid, byte 0 is\n");
+        EMIT_LIT(out, "    // data_in_inv_res[INPUT_WIDTH-1 -: 8], lfsr_c_b<n> takes the first n bytes\n");
+
+        for (int b = 1; b < num_bytes; b++)
+        {
+            char name[32];
+
+            sprintf(name, "lfsr_c_b%d", b);
+            EMIT_LIT(out, "    always @(*) begin");
+            emit_equations(out, lfsr_eq, &lfsr_eq->keep_rows[b - 1], num_data_bits - 8 * b, name, false);
+            EMIT_LIT(out, "\n    end // always\n\n");
+        }
+    }
+
+    if (lanes)
+    {
+        emit_fmt(out, "    // partial CRC of each %d bit lane, lane_c<l> reads data_in_inv_res[%d*l +: %d]\n",
+                 lanes->lane_width, lanes->lane_width, lanes->lane_width);
+
+        for (int l = 0; l < lanes->lanes; l++)
+        {
+            char name[32];
+
+            sprintf(name, "lane_c%d", l);
+            EMIT_LIT(out, "    always @(*) begin");
+            emit_equations(out, lfsr_eq, &lanes->lane_rows, l * lanes->lane_width, name, false);
+            EMIT_LIT(out, "\n    end // always\n\n");
+        }
+
+        EMIT_LIT(out, "    // the lane stage ends in a register, the combine stage reads it a clock later\n");
+        EMIT_LIT(out, "    always @(posedge clk) begin\n");
+
+        for (int l = 0; l < lanes->lanes; l++)
+            emit_fmt(out, "        lane_crc%d <= lane_c%d;\n", l, l);
+
+        EMIT_LIT(out, "    end // always\n\n");
+        EMIT_LIT(out, "    // lfsr_q and the lane CRCs shifted by the lanes shifted in after them\n");
+    }
+
+    EMIT_LIT(out, "    always @(*) begin");
+
+    emit_equations(out, lfsr_eq, NULL, 0, lfsr_c_name, false);
+    EMIT_LIT(out, "\n    end // always\n\n");
+
+    if (lfsr_eq->keep_rows)
+    {
+        EMIT_LIT(out, "    // select the equation set by the number of valid bytes\n");
+        EMIT_LIT(out, "    always @(*) begin\n");
+        EMIT_LIT(out, "        case (data_keep)\n");
+
+        for (int b = 1; b < num_bytes; b++)
+        {
+            EMIT_LIT(out, "            ");
+            emit_int(out, num_bytes);
+            EMIT_LIT(out, "'b");
+
+            for (int i = num_bytes - 1; i >= 0; i--)
+                emit_mem(out, i < b ? "1" : "0", 1);
+
+            emit_fmt(out, ": lfsr_c = lfsr_c_b%d;\n", b);
+        }
+
+        emit_fmt(out, "            default: lfsr_c = %s;\n", lfsr_c_name);
+        EMIT_LIT(out, "        endcase\n");
+        EMIT_LIT(out, "    end // always\n\n");
+    }
+
+    EMIT_LIT(out, "    always @(posedge clk, posedge rst) begin\n");
+    EMIT_LIT(out, "        if (rst) begin\n");
+    EMIT_LIT(out, "            lfsr_q <= INIT;\n");
+
+    if (latency)
+    {
+        EMIT_LIT(out, "            crc_valid <= 1'b0;\n");
+        EMIT_LIT(out, "        end else begin\n");
+        emit_fmt(out, "            lfsr_q <= crc_en_p[%d] ? lfsr_c : lfsr_q;\n", latency - 1);
+        emit_fmt(out, "            crc_valid <= crc_en_p[%d];\n", latency - 1);
+    }
+    else if (fold > 1)
+    {
+        EMIT_LIT(out, "            fold_cnt <= 0;\n");
+        EMIT_LIT(out, "        end else if (!crc_ready) begin\n");
+        EMIT_LIT(out, "            lfsr_q <= lfsr_c;\n");
+        EMIT_LIT(out, "            fold_cnt <= fold_cnt - 1'b1;\n");
+        EMIT_LIT(out, "        end else if (crc_en) begin\n");
+        EMIT_LIT(out, "            lfsr_q <= lfsr_c;\n");
+        EMIT_LIT(out, "            fold_cnt <= FOLD-1;\n");
+    }
+    else
+    {
+        EMIT_LIT(out, "        end else begin\n");
+        EMIT_LIT(out, "            lfsr_q <= crc_en ? lfsr_c : lfsr_q;\n");
+    }
+
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "    end // always\n");
+    EMIT_LIT(out, "endmodule // crc\n");
+    EMIT_LIT(out, "\n");
+
+} // print_verilog_crc
+
+void print_vhdl_crc(emit_buf *out,
+                    int lfsr_poly_size,
+                    int num_data_bits,
+                    const gf2_word *lfsr_poly,
+                    crc_equations *lfsr_eq)
+{
+    const crc_pipeline *pipe = lfsr_eq->pipeline;
+    const crc_lanes *lanes = lfsr_eq->lanes;
+    int latency = pipe ? pipe->stages : (lanes ? 1 : 0); // the lane CRCs are registered
+    int fold = lfsr_eq->fold;
+    int num_bytes = lfsr_eq->num_keep_sets + 1;
+    char lfsr_c_name[32] = "lfsr_c";
+
+    // with byte enables the full beat is the last of the equation sets
+    if (lfsr_eq->keep_rows)
+        sprintf(lfsr_c_name, "lfsr_c_b%d", num_bytes);
+
+    EMIT_LIT(out, "\n-------------------------------------------------------------------------------");
+    EMIT_LIT(out, "\n-- Copyright (C) 2009 OutputLogic.com");
+    EMIT_LIT(out, "\n-- This source file may be used and distributed without restriction");
+    EMIT_LIT(out, "\n-- provided that this copyright statement is not removed from the file");
+    EMIT_LIT(out, "\n-- and that any derivative work contains the original copyright notice");
+    EMIT_LIT(out, "\n-- and the associated disclaimer.");
+    EMIT_LIT(out, "\n-- THIS SOURCE FILE IS PROVIDED \"AS IS\" AND WITHOUT ANY EXPRESS");
+    EMIT_LIT(out, "\n-- OR IMPLIED WARRANTIES, INCLUDING, WITHOUT LIMITATION, THE IMPLIED");
+    EMIT_LIT(out, "\n-- WARRANTIES OF MERCHANTIBILITY AND FITNESS FOR A PARTICULAR PURPOSE.");
+    EMIT_LIT(out, "\n-------------------------------------------------------------------------------\n");
+
+    EMIT_LIT(out, "-- CRC module for\n");
+    emit_fmt(out, "--    data(%d:0)\n", num_data_bits - 1);
+    emit_fmt(out, "--    crc(%d:0)=", lfsr_poly_size - 1);
+
+    for (int l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), 0); l >= 0; l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), l + 1))
+    {
+        if (l)
+            emit_fmt(out, "+x^%d", l);
+        else
+            EMIT_LIT(out, "1");
+    }
+    emit_fmt(out, "+x^%d;\n\n", lfsr_poly_size);
+
+    EMIT_LIT(out, "library ieee;                   \n");
+    EMIT_LIT(out, "use ieee.std_logic_1164.all;    \n");
+    EMIT_LIT(out, "\n-------------------------------------------------------------------------------\n");
+
+    EMIT_LIT(out, "entity crc is\n");
+    EMIT_LIT(out, "    generic (\n");
+    emit_fmt(out, "        INPUT_WIDTH  : integer := %d;\n", num_data_bits);
+    emit_fmt(out, "        OUTPUT_WIDTH : integer := %d;\n", lfsr_poly_size);
+    emit_fmt(out, "        INIT         : std_logic_vector(%d downto 0) := (others => '1');\n", lfsr_poly_size - 1);
+    emit_fmt(out, "        OUTPUT_XOR   : std_logic_vector(%d downto 0) := (others => '0');\n", lfsr_poly_size - 1);
+    EMIT_LIT(out, "        INPUT_INV    : std_logic := '0';\n");
+    EMIT_LIT(out, "        OUTPUT_INV   : std_logic := '0'\n");
+    EMIT_LIT(out, "    );\n");
+    EMIT_LIT(out, "    port (\n");
+    EMIT_LIT(out, "        data_in : in  std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "        crc_en  : in  std_logic;\n");
+
+    if (lfsr_eq->keep_rows)
+        EMIT_LIT(out, "        data_keep : in std_logic_vector((INPUT_WIDTH/8-1) downto 0);\n");
+
+    EMIT_LIT(out, "        crc_out : out std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+
+    if (latency)
+        EMIT_LIT(out, "        crc_valid : out std_logic;\n");
+
+    if (fold > 1)
+        EMIT_LIT(out, "        crc_ready : out std_logic;\n");
+
+    EMIT_LIT(out, "        rst     : in  std_logic;\n");
+    EMIT_LIT(out, "        clk     : in  std_logic\n");
+    EMIT_LIT(out, "    );\n");
+    EMIT_LIT(out, "end entity crc;\n");
+
+    EMIT_LIT(out, "architecture imp_crc of crc is	 \n");
+    EMIT_LIT(out, "    signal data_in_inv      : std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal data_in_inv_res  : std_logic_vector((INPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal crc_out_inv      : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal crc_out_inv_res  : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal lfsr_q           : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal lfsr_c           : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+
+    if (lfsr_eq->num_shared)
+        emit_fmt(out, "    signal xor_shared       : std_logic_vector(%d downto 0);\n", lfsr_eq->num_shared - 1);
+
+    for (int l = 0; lanes && l < lanes->lanes; l++)
+    {
+        emit_fmt(out, "    signal lane_c%-10d : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n", l);
+        emit_fmt(out, "    signal lane_crc%-8d : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n", l);
+    }
+
+    for (int l = 0; lfsr_eq->lut6 && l + 1 < (int)lfsr_eq->lut6->level_start.size(); l++)
+    {
+        int n = lfsr_eq->lut6->level_start[l + 1] - lfsr_eq->lut6->level_start[l];
+
+        if (n)
+            emit_fmt(out, "    signal lut6_l%-10d : std_logic_vector(%d downto 0);\n", l + 1, n - 1);
+    }
+
+    if (lfsr_eq->keep_rows)
+    {
+        for (int b = 1; b <= num_bytes; b++)
+            emit_fmt(out, "    signal lfsr_c_b%-8d : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n", b);
+    }
+
+    if (latency)
+    {
+        emit_fmt(out, "    -- data_in to lfsr_q register stages\n    constant LATENCY        : integer := %d;\n", latency);
+
+        for (int s = 0; pipe && s < pipe->stages; s++)
+            emit_fmt(out, "    signal data_p%-10d : std_logic_vector(%d downto 0);\n", s + 1, (int)pipe->nodes[s].size() - 1);
+
+        emit_fmt(out, "    signal crc_en_p         : std_logic_vector(%d downto 0);\n", latency - 1);
+    }
+
+    if (fold > 1)
+    {
+        emit_fmt(out, "    -- data_in beat taken over FOLD clocks, a slice per clock\n    constant FOLD           : integer := %d;\n", fold);
+        EMIT_LIT(out, "    constant SLICE_WIDTH    : integer := INPUT_WIDTH/FOLD;\n");
+        EMIT_LIT(out, "    constant SLICE_ZERO     : std_logic_vector((SLICE_WIDTH-1) downto 0) := (others => '0');\n");
+        EMIT_LIT(out, "    signal data_sr          : std_logic_vector((INPUT_WIDTH-SLICE_WIDTH-1) downto 0);\n");
+        EMIT_LIT(out, "    signal data_slice       : std_logic_vector((SLICE_WIDTH-1) downto 0);\n");
+        EMIT_LIT(out, "    signal fold_cnt         : integer range 0 to FOLD-1;\n");
+        EMIT_LIT(out, "    signal crc_ready_i      : std_logic;\n");
+    }
+    EMIT_LIT(out, "begin\n\n");
+
+    EMIT_LIT(out, "    -- input reverse\n");
+    EMIT_LIT(out, "    gen_data_in_inv: for ii in 0 to INPUT_WIDTH-1 generate\n");
+    EMIT_LIT(out, "        data_in_inv(ii) <= data_in(INPUT_WIDTH-ii-1);\n");
+    EMIT_LIT(out, "    end generate gen_data_in_inv;\n");
+    EMIT_LIT(out, "\n");
+    EMIT_LIT(out, "    -- output reverse\n");
+    EMIT_LIT(out, "    gen_crc_out_inv: for ii in 0 to OUTPUT_WIDTH-1 generate\n");
+    EMIT_LIT(out, "        crc_out_inv(ii) <= lfsr_q(OUTPUT_WIDTH-ii-1);\n");
+    EMIT_LIT(out, "    end generate gen_crc_out_inv;\n");
+    EMIT_LIT(out, "\n");
+    EMIT_LIT(out, "    -- input reverse\n");
+    EMIT_LIT(out, "    data_in_inv_res <= data_in_inv when INPUT_INV = '1' else data_in;\n");
+    EMIT_LIT(out, "    -- output reverse\n");
+    EMIT_LIT(out, "    crc_out_inv_res <= crc_out_inv when OUTPUT_INV = '1' else lfsr_q;\n");
+    EMIT_LIT(out, "    -- output xor\n");
+    EMIT_LIT(out, "    crc_out <= crc_out_inv_res xor OUTPUT_XOR;\n");
+
+    if (lfsr_eq->num_shared)
+    {
+        EMIT_LIT(out, "\n    -- shared XOR terms");
+
+        for (int k = 0; k < lfsr_eq->num_shared; k++)
+        {
+            EMIT_LIT(out, "\n    xor_shared(");
+            emit_int(out, k);
+            EMIT_LIT(out, ") <= ");
+            emit_crc_term(out, lfsr_eq, lfsr_eq->shared_pairs[2 * k], true);
+            EMIT_LIT(out, " xor ");
+            emit_crc_term(out, lfsr_eq, lfsr_eq->shared_pairs[2 * k + 1], true);
+            EMIT_LIT(out, ";");
+        }
+
+        EMIT_LIT(out, "\n");
+    }
+
+    if (lfsr_eq->lut6)
+        emit_lut6_groups(out, lfsr_eq, true);
+
+    if (pipe)
+    {
+        EMIT_LIT(out, "\n    -- data terms, balanced XOR trees\n");
+        EMIT_LIT(out, "    process (clk) begin\n");
+        EMIT_LIT(out, "        if rising_edge(clk) then\n");
+
+        for (int s = 0; s < pipe->stages; s++)
+        {
+            for (int i = 0; i < (int)pipe->nodes[s].size(); i++)
+            {
+                EMIT_LIT(out, "            data_p");
+                emit_int(out, s + 1);
+                EMIT_LIT(out, "(");
+                emit_int(out, i);
+                EMIT_LIT(out, ") <= ");
+                emit_pipeline_node(out, pipe, s, i, true);
+                EMIT_LIT(out, ";\n");
+            }
+        }
+
+        EMIT_LIT(out, "        end if;\n");
+        EMIT_LIT(out, "    end process;\n");
+    }
+
+    if (latency)
+    {
+        EMIT_LIT(out, "\n    process (clk, rst) begin\n");
+        EMIT_LIT(out, "        if rst = '1' then\n");
+        EMIT_LIT(out, "            crc_en_p <= (others => '0');\n");
+        EMIT_LIT(out, "        elsif rising_edge(clk) then\n");
+
+        if (latency > 1)
+            emit_fmt(out, "            crc_en_p <= crc_en_p(%d downto 0) & crc_en;\n", latency - 2);
+        else
+            EMIT_LIT(out, "            crc_en_p(0) <= crc_en;\n");
+
+        EMIT_LIT(out, "        end if;\n");
+        EMIT_LIT(out, "    end process;\n");
+    }
+
+    if (fold > 1)
+    {
+        EMIT_LIT(out, "\n    -- the first slice comes straight from data_in, the rest from data_sr\n");
+        EMIT_LIT(out, "    crc_ready_i <= '1' when fold_cnt = 0 else '0';\n");
+        EMIT_LIT(out, "    crc_ready   <= crc_ready_i;\n");
+        EMIT_LIT(out, "    data_slice  <= data_in_inv_res((INPUT_WIDTH-1) downto (INPUT_WIDTH-SLICE_WIDTH)) when crc_ready_i = '1' else\n");
+        EMIT_LIT(out, "                   data_sr((INPUT_WIDTH-SLICE_WIDTH-1) downto (INPUT_WIDTH-2*SLICE_WIDTH));\n\n");
+        EMIT_LIT(out, "    process (clk) begin\n");
+        EMIT_LIT(out, "        if rising_edge(clk) then\n");
+        EMIT_LIT(out, "            if crc_ready_i = '1' then\n");
+        EMIT_LIT(out, "                data_sr <= data_in_inv_res((INPUT_WIDTH-SLICE_WIDTH-1) downto 0);\n");
+        EMIT_LIT(out, "            else\n");
+        EMIT_LIT(out, "                data_sr <= data_sr((INPUT_WIDTH-2*SLICE_WIDTH-1) downto 0) & SLICE_ZERO;\n");
+        EMIT_LIT(out, "            end if;\n");
+        EMIT_LIT(out, "        end if;\n");
+        EMIT_LIT(out, "    end process;\n");
+    }
+
+    if (lfsr_eq->keep_rows)
+    {
+        EMIT_LIT(out, "\n    -- partial beats: data_keep(i) marks byte i in shift order valid, byte 0 is");
+        EMIT_LIT(out, "\n    -- data_in_inv_res(INPUT_WIDTH-1 downto INPUT_WIDTH-8), lfsr_c_b<n> takes the first n bytes");
+
+        for (int b = 1; b < num_bytes; b++)
+        {
+            char name[32];
+
+            sprintf(name, "lfsr_c_b%d", b);
+            emit_equations(out, lfsr_eq, &lfsr_eq->keep_rows[b - 1], num_data_bits - 8 * b, name, true);
+            EMIT_LIT(out, "\n");
+        }
+    }
+
+    if (lanes)
+    {
+        emit_fmt(out, "\n    -- partial CRC of each %d bit lane, lane_c<l> reads data_in_inv_res(%d*l+%d downto %d*l)",
+                 lanes->lane_width, lanes->lane_width, lanes->lane_width - 1, lanes->lane_width);
+
+        for (int l = 0; l < lanes->lanes; l++)
+        {
+            char name[32];
+
+            sprintf(name, "lane_c%d", l);
+            emit_equations(out, lfsr_eq, &lanes->lane_rows, l * lanes->lane_width, name, true);
+            EMIT_LIT(out, "\n");
+        }
+
+        EMIT_LIT(out, "\n    -- the lane stage ends in a register, the combine stage reads it a clock later\n");
+        EMIT_LIT(out, "    process (clk) begin\n");
+        EMIT_LIT(out, "        if rising_edge(clk) then\n");
+
+        for (int l = 0; l < lanes->lanes; l++)
+            emit_fmt(out, "            lane_crc%d <= lane_c%d;\n", l, l);
+
+        EMIT_LIT(out, "        end if;\n");
+        EMIT_LIT(out, "    end process;\n");
+
+        EMIT_LIT(out, "\n    -- lfsr_q and the lane CRCs shifted by the lanes shifted in after them");
+    }
+
+    emit_equations(out, lfsr_eq, NULL, 0, lfsr_c_name, true);
+
+    if (lfsr_eq->keep_rows)
+    {
+        EMIT_LIT(out, "\n\n    -- select the equation set by the number of valid bytes\n");
+        EMIT_LIT(out, "    with data_keep select lfsr_c <=\n");
+
+        for (int b = 1; b < num_bytes; b++)
+        {
+            emit_fmt(out, "        lfsr_c_b%d when \"", b);
+
+            for (int i = num_bytes - 1; i >= 0; i--)
+                emit_mem(out, i < b ? "1" : "0", 1);
+
+            EMIT_LIT(out, "\",\n");
+        }
+
+        emit_fmt(out, "        %s when others;", lfsr_c_name);
+    }
+
+    EMIT_LIT(out, "\n\n");
+
+    EMIT_LIT(out, "    process (clk, rst) begin\n");
+    EMIT_LIT(out, "        if rst = '1' then\n");
+    EMIT_LIT(out, "            lfsr_q <= INIT;\n");
+
+    if (latency)
+    {
+        EMIT_LIT(out, "            crc_valid <= '0';\n");
+        EMIT_LIT(out, "        elsif rising_edge(clk) then\n");
+        emit_fmt(out, "            crc_valid <= crc_en_p(%d);\n", latency - 1);
+        emit_fmt(out, "            if crc_en_p(%d) = '1' then\n", latency - 1);
+    }
+    else if (fold > 1)
+    {
+        EMIT_LIT(out, "            fold_cnt <= 0;\n");
+        EMIT_LIT(out, "        elsif rising_edge(clk) then\n");
+        EMIT_LIT(out, "            if crc_ready_i = '0' then\n");
+        EMIT_LIT(out, "                lfsr_q <= lfsr_c;\n");
+        EMIT_LIT(out, "                fold_cnt <= fold_cnt - 1;\n");
+        EMIT_LIT(out, "            elsif crc_en = '1' then\n");
+        EMIT_LIT(out, "                fold_cnt <= FOLD - 1;\n");
+    }
+    else
+    {
+        EMIT_LIT(out, "        elsif rising_edge(clk) then\n");
+        EMIT_LIT(out, "            if crc_en = '1' then\n");
+    }
+
+    EMIT_LIT(out, "                lfsr_q <= lfsr_c;\n");
+    EMIT_LIT(out, "            else\n");
+    EMIT_LIT(out, "                null;\n");
+    EMIT_LIT(out, "            end if;\n");
+    EMIT_LIT(out, "        end if;\n");
+    EMIT_LIT(out, "    end process;\n\n");
+    EMIT_LIT(out, "end architecture imp_crc; \n");
+
+} // print_vhdl_crc
@@ -0,0 +1,199 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "cse.h"
+
+int xor2_count(const gf2_matrix *eq, int num_shared)
+{
+    int gates = num_shared;
+
+    for (int r = 0; r < eq->rows; r++)
+    {
+        int terms = gf2_vec_popcount(gf2_row(eq, r), eq->words);
+
+        if (terms > 1)
+            gates += terms - 1;
+    }
+
+    return gates;
+}
+
+//
+// the search runs on the transposed matrix: every signal is a column vector
+// over the equations, so the number of equations a pair shares is one AND and
+// popcount. each signal caches its best partner; after an extraction only the
+// two inputs, the new signal and the signals whose best partner was one of
+// the inputs need a full rescan, everybody else just checks the new signal.
+//
+bool xor_cse(const gf2_matrix *eq, gf2_matrix *out, std::vector<int> *pairs)
+{
+    int words = GF2_WORDS(eq->rows);
+    int num_cols = eq->cols;
+
+    std::vector<gf2_word> cols((size_t)num_cols * words, 0);
+    std::vector<int> best_cnt;
+    std::vector<int> best_partner;
+
+    pairs->clear();
+
+    for (int r = 0; r < eq->rows; r++)
+    {
+        const gf2_word *row = gf2_row(eq, r);
+
+        for (int c = gf2_next_set(row, eq->words, 0); c >= 0; c = gf2_next_set(row, eq->words, c + 1))
+            gf2_set(&cols[(size_t)c * words], r);
+    }
+
+    // signals used by fewer than two equations can not be shared
+    std::vector<int> active;
+
+    for (int c = 0; c < num_cols; c++)
+    {
+        if (gf2_vec_popcount(&cols[(size_t)c * words], words) > 1)
+            active.push_back(c);
+    }
+
+    best_cnt.assign(num_cols, 0);
+    best_partner.assign(num_cols, -1);
+
+    std::vector<gf2_word> common(words);
+
+    // count of equations that use both a and b
+    auto shared = [&](int a, int b)
+    {
+        const gf2_word *va = &cols[(size_t)a * words];
+        const gf2_word *vb = &cols[(size_t)b * words];
+        int n = 0;
+
+        for (int w = 0; w < words; w++)
+            n += gf2_popcount_word(va[w] & vb[w]);
+
+        return n;
+    };
+
+    auto rescan = [&](int a)
+    {
+        best_cnt[a] = 0;
+        best_partner[a] = -1;
+
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            int b = active[i];
+            int n;
+
+            if (b != a && (n = shared(a, b)) > best_cnt[a])
+            {
+                best_cnt[a] = n;
+                best_partner[a] = b;
+            }
+        }
+    };
+
+    for (size_t i = 0; i < active.size(); i++)
+        rescan(active[i]);
+
+    for (;;)
+    {
+        int a = -1;
+
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            int c = active[i];
+
+            if (best_cnt[c] > 1 && (a < 0 || best_cnt[c] > best_cnt[a]))
+                a = c;
+        }
+
+        if (a < 0)
+            break;
+
+        int b = best_partner[a];
+        int n = num_cols++;
+
+        // new signal n takes over the equations that use both a and b
+        for (int w = 0; w < words; w++)
+            common[w] = cols[(size_t)a * words + w] & cols[(size_t)b * words + w];
+
+        cols.insert(cols.end(), common.begin(), common.end());
+
+        for (int w = 0; w < words; w++)
+        {
+            cols[(size_t)a * words + w] &= ~common[w];
+            cols[(size_t)b * words + w] &= ~common[w];
+        }
+
+        pairs->push_back(a);
+        pairs->push_back(b);
+        best_cnt.push_back(0);
+        best_partner.push_back(-1);
+
+        // drop a and b if they are no longer shared, add n
+        size_t kept = 0;
+
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            int c = active[i];
+
+            if ((c != a && c != b) || gf2_vec_popcount(&cols[(size_t)c * words], words) > 1)
+                active[kept++] = c;
+            else
+                best_cnt[c] = 0;
+        }
+
+        active.resize(kept);
+        active.push_back(n);
+
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            int c = active[i];
+            int cnt;
+
+            if (c == a || c == b || c == n || best_partner[c] == a || best_partner[c] == b)
+                rescan(c);
+            else if ((cnt = shared(c, n)) > best_cnt[c])
+            {
+                best_cnt[c] = cnt;
+                best_partner[c] = n;
+            }
+        }
+    }
+
+    // back to one row per equation
+    if (!gf2_matrix_alloc(out, eq->rows, num_cols))
+        return false;
+
+    for (int c = 0; c < num_cols; c++)
+    {
+        const gf2_word *col = &cols[(size_t)c * words];
+
+        for (int r = gf2_next_set(col, words, 0); r >= 0; r = gf2_next_set(col, words, r + 1))
+            gf2_set(gf2_row(out, r), c);
+    }
+
+    return true;
+}
@@ -0,0 +1,53 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CSE_H
+#define CSE_H
+
+#include <vector>
+
+#include "gf2.h"
+
+//
+// shared XOR extraction on a set of XOR equations
+//
+// the rows of eq are the equations, the columns their input signals. the pass
+// follows Paar's greedy algorithm: as long as some pair of signals appears
+// together in two or more equations, the pair that appears most often becomes
+// a new signal, and the equations use it instead of the two inputs.
+//
+// on return out has the same rows over eq->cols + K columns, and new signal k
+// (column eq->cols + k) is the XOR of columns pairs[2k] and pairs[2k+1], which
+// may themselves be earlier new signals. returns false on failed allocation.
+//
+bool xor_cse(const gf2_matrix *eq, gf2_matrix *out, std::vector<int> *pairs);
+
+// number of 2-input XOR gates for the rows of eq, plus num_shared extra gates
+int xor2_count(const gf2_matrix *eq, int num_shared);
+
+#endif // CSE_H
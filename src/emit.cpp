@@ -0,0 +1,192 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdarg.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include "emit.h"
+
+bool emit_open(emit_buf *b, const char *path, size_t flush_at)
+{
+    memset(b, 0, sizeof(*b));
+    b->flush_at = flush_at;
+    b->cap = flush_at ? flush_at : (size_t)1 << 20;
+    b->data = (char *)malloc(b->cap);
+
+    if (!b->data)
+        return false;
+
+    if (!path)
+    {
+        b->sink = stdout;
+        return true;
+    }
+
+    b->path = (char *)malloc(strlen(path) + 1);
+    b->tmp_path = (char *)malloc(strlen(path) + 5);
+
+    if (b->path && b->tmp_path)
+    {
+        strcpy(b->path, path);
+        strcpy(b->tmp_path, path);
+        strcat(b->tmp_path, ".tmp");
+
+        b->sink = fopen(b->tmp_path, "wb");
+    }
+
+    if (!b->sink)
+    {
+        free(b->data);
+        free(b->path);
+        free(b->tmp_path);
+        memset(b, 0, sizeof(*b));
+        return false;
+    }
+
+    return true;
+}
+
+bool emit_open_file(emit_buf *b, FILE *sink, size_t flush_at)
+{
+    memset(b, 0, sizeof(*b));
+    b->flush_at = flush_at;
+    b->cap = flush_at ? flush_at : (size_t)1 << 20;
+    b->data = (char *)malloc(b->cap);
+    b->sink = sink;
+
+    return b->data != NULL;
+}
+
+bool emit_reserve(emit_buf *b, size_t n)
+{
+    if (b->flush_at && b->len)
+        emit_flush(b);
+
+    if (b->len + n <= b->cap)
+        return true;
+
+    size_t cap = b->cap;
+
+    while (b->len + n > cap)
+        cap *= 2;
+
+    char *data = (char *)realloc(b->data, cap);
+
+    if (!data)
+    {
+        b->failed = true;
+        return false;
+    }
+
+    b->data = data;
+    b->cap = cap;
+
+    return true;
+}
+
+void emit_flush(emit_buf *b)
+{
+    if (!b->len)
+        return;
+
+    if (fwrite(b->data, 1, b->len, b->sink) != b->len)
+        b->failed = true;
+
+    b->bytes += b->len;
+    b->writes++;
+    b->len = 0;
+}
+
+void emit_fmt(emit_buf *b, const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    int n = vsnprintf(b->data + b->len, b->cap - b->len, fmt, ap);
+    va_end(ap);
+
+    if (n < 0)
+    {
+        b->failed = true;
+        return;
+    }
+
+    if (b->len + n >= b->cap)
+    {
+        if (!emit_reserve(b, n + 1))
+            return;
+
+        va_start(ap, fmt);
+        vsnprintf(b->data + b->len, b->cap - b->len, fmt, ap);
+        va_end(ap);
+    }
+
+    b->len += n;
+}
+
+bool emit_close(emit_buf *b)
+{
+    emit_flush(b);
+
+    if (b->sink && fflush(b->sink))
+        b->failed = true;
+
+    if (b->tmp_path)
+    {
+        if (b->sink && fclose(b->sink))
+            b->failed = true;
+
+        if (b->failed)
+        {
+            remove(b->tmp_path);
+        }
+#if defined(_WIN32)
+        else if (!MoveFileExA(b->tmp_path, b->path, MOVEFILE_REPLACE_EXISTING))
+#else
+        else if (rename(b->tmp_path, b->path))
+#endif
+        {
+            remove(b->tmp_path);
+            b->failed = true;
+        }
+    }
+
+    free(b->data);
+    free(b->path);
+    free(b->tmp_path);
+    b->data = NULL;
+    b->path = NULL;
+    b->tmp_path = NULL;
+    b->sink = NULL;
+
+    return !b->failed;
+}
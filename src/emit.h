@@ -0,0 +1,118 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef EMIT_H
+#define EMIT_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+//
+// output buffer for the generated HDL
+//
+// everything is formatted into one growing buffer and written with a single
+// fwrite at the end. if flush_at is set the buffer is written out whenever it
+// grows past that size instead, which keeps memory bounded in streaming mode.
+//
+struct emit_buf
+{
+    char *data;
+    size_t len;
+    size_t cap;
+    size_t flush_at; // 0 = keep everything until emit_close()
+    FILE *sink;
+    char *tmp_path; // set when writing to a file through a temporary
+    char *path;
+    size_t bytes;  // total bytes emitted
+    int writes;    // number of fwrite calls issued to the sink
+    bool failed;
+};
+
+// path NULL writes to stdout, otherwise to path.tmp which is renamed over path
+// by emit_close(), so readers never see a half written file.
+// on failure nothing is left to clean up.
+bool emit_open(emit_buf *b, const char *path, size_t flush_at);
+
+// the same on an open stream, which emit_close() flushes but leaves open
+bool emit_open_file(emit_buf *b, FILE *sink, size_t flush_at);
+
+// flush and close, returns false if anything failed along the way
+bool emit_close(emit_buf *b);
+
+// make room for n more bytes: flushes first when flush_at is set, else grows.
+// false if the buffer can not grow, failed is then set and the caller drops
+// its write
+bool emit_reserve(emit_buf *b, size_t n);
+void emit_flush(emit_buf *b);
+void emit_fmt(emit_buf *b, const char *fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+static inline void emit_mem(emit_buf *b, const char *s, size_t n)
+{
+    if (b->len + n > b->cap && !emit_reserve(b, n))
+        return;
+
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+}
+
+static inline void emit_str(emit_buf *b, const char *s)
+{
+    emit_mem(b, s, strlen(s));
+}
+
+// string literals only, the length is taken at compile time
+#define EMIT_LIT(b, s) emit_mem((b), (s), sizeof(s) - 1)
+
+static inline void emit_int(emit_buf *b, int v)
+{
+    char tmp[12];
+    int n = 0;
+    unsigned int u = v < 0 ? 0u - (unsigned int)v : (unsigned int)v;
+
+    do
+    {
+        tmp[n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+
+    if (v < 0)
+        tmp[n++] = '-';
+
+    if (b->len + n > b->cap && !emit_reserve(b, n))
+        return;
+
+    while (n)
+        b->data[b->len++] = tmp[--n];
+}
+
+#endif // EMIT_H
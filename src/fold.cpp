@@ -0,0 +1,85 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "cost.h"
+#include "fold.h"
+
+int fold_counter_bits(int fold)
+{
+    int bits = 1;
+
+    while ((1 << bits) < fold)
+        bits++;
+
+    return bits;
+}
+
+struct fold_cost
+{
+    int max_inputs;
+    long long xor2_gates;
+    long long lut6;
+};
+
+static fold_cost equation_cost(const gf2_matrix *eq, int N)
+{
+    fold_cost c = {0, 0, 0};
+
+    for (int n2 = 0; n2 < N; n2++)
+    {
+        int n = gf2_vec_popcount(gf2_row(eq, n2), eq->words);
+
+        if (c.max_inputs < n)
+            c.max_inputs = n;
+
+        c.xor2_gates += n > 1 ? n - 1 : 0;
+        c.lut6 += lut6_count(n);
+    }
+
+    return c;
+}
+
+void report_fold(FILE *fp, const char *name, const gf2_matrix *flat, const gf2_matrix *slice, int N, int M, int fold)
+{
+    int W = M / fold;
+    fold_cost f = equation_cost(flat, N);
+    fold_cost s = equation_cost(slice, N);
+
+    // one 2:1 mux per slice bit, and the shift register loads or shifts
+    long long mux_lut6 = M;
+    int regs = N + (M - W) + fold_counter_bits(fold);
+
+    fprintf(fp, "%s: fold %d: %d bit slices, %d clocks per %d bit beat, %d bits per clock (flat %d)\n",
+            name, fold, W, fold, M, W, M);
+
+    fprintf(fp, "%s: folded: max %d inputs, %d xor2 levels, %lld xor2 gates, %lld lut6 + %lld mux lut6, %d registers\n",
+            name, s.max_inputs, xor2_levels(s.max_inputs), s.xor2_gates, s.lut6, mux_lut6, regs);
+
+    fprintf(fp, "%s: flat: max %d inputs, %d xor2 levels, %lld xor2 gates, %lld lut6, %d registers\n",
+            name, f.max_inputs, xor2_levels(f.max_inputs), f.xor2_gates, f.lut6, N);
+}
@@ -0,0 +1,53 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <stdio.h>
+
+#include "gf2.h"
+
+//
+// folded data path for wide buses on slow or small parts
+//
+// the equations are built for a slice of W = M/F bits, and the core takes one
+// M bit beat over F clocks: the first slice is data_in_inv_res[M-1 -: W], the
+// rest is held in a shift register and fed in on the following clocks, while
+// crc_ready is low. F times less XOR logic for F times less throughput, plus
+// the mux and the M-W bit shift register.
+//
+
+// width of the fold_cnt register that counts the clocks of a beat
+int fold_counter_bits(int fold);
+
+// slice width, clocks per beat, throughput and XOR2 / LUT6 / register cost of
+// the folded core (slice, N x (N+W)) against the flat one (flat, N x (N+M))
+void report_fold(FILE *fp, const char *name, const gf2_matrix *flat, const gf2_matrix *slice, int N, int M, int fold);
+
+#endif // FOLD_H
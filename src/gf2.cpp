@@ -0,0 +1,60 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdlib.h>
+
+#include "gf2.h"
+
+void gf2_vec_shl1(gf2_word *v, int nbits)
+{
+    int words = GF2_WORDS(nbits);
+
+    for (int i = words - 1; i > 0; i--)
+        v[i] = (v[i] << 1) | (v[i - 1] >> (GF2_WORD_BITS - 1));
+
+    v[0] <<= 1;
+
+    if (nbits % GF2_WORD_BITS)
+        v[words - 1] &= ((gf2_word)1 << (nbits % GF2_WORD_BITS)) - 1;
+}
+
+bool gf2_matrix_alloc(gf2_matrix *m, int rows, int cols)
+{
+    m->rows = rows;
+    m->cols = cols;
+    m->words = GF2_WORDS(cols);
+    m->bits = (gf2_word *)calloc((size_t)rows * m->words, sizeof(gf2_word));
+
+    return m->bits != NULL;
+}
+
+void gf2_matrix_free(gf2_matrix *m)
+{
+    free(m->bits);
+    m->bits = NULL;
+}
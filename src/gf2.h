@@ -0,0 +1,185 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef GF2_H
+#define GF2_H
+
+#include <stdint.h>
+#include <string.h>
+
+//
+// bit-packed GF(2) vectors and matrices
+//
+// a vector of n bits is stored in GF2_WORDS(n) 64-bit words, bit i lives in
+// word i/64 at position i%64. bits above n in the last word are always zero.
+//
+
+typedef uint64_t gf2_word;
+
+#define GF2_WORD_BITS 64
+#define GF2_WORDS(nbits) (((nbits) + GF2_WORD_BITS - 1) / GF2_WORD_BITS)
+
+static inline int gf2_ctz(gf2_word w)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(w);
+#else
+    int n = 0;
+    while (!(w & 1))
+    {
+        w >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static inline int gf2_popcount_word(gf2_word w)
+{
+#if defined(__GNUC__)
+    return __builtin_popcountll(w);
+#else
+    int n = 0;
+    for (; w; w &= w - 1)
+        n++;
+    return n;
+#endif
+}
+
+static inline int gf2_get(const gf2_word *v, int i)
+{
+    return (int)((v[i / GF2_WORD_BITS] >> (i % GF2_WORD_BITS)) & 1);
+}
+
+static inline void gf2_set(gf2_word *v, int i)
+{
+    v[i / GF2_WORD_BITS] |= (gf2_word)1 << (i % GF2_WORD_BITS);
+}
+
+static inline void gf2_clear(gf2_word *v, int i)
+{
+    v[i / GF2_WORD_BITS] &= ~((gf2_word)1 << (i % GF2_WORD_BITS));
+}
+
+static inline void gf2_flip(gf2_word *v, int i)
+{
+    v[i / GF2_WORD_BITS] ^= (gf2_word)1 << (i % GF2_WORD_BITS);
+}
+
+static inline void gf2_vec_zero(gf2_word *v, int words)
+{
+    memset(v, 0, sizeof(gf2_word) * words);
+}
+
+static inline void gf2_vec_copy(gf2_word *dst, const gf2_word *src, int words)
+{
+    memcpy(dst, src, sizeof(gf2_word) * words);
+}
+
+// dst ^= src
+static inline void gf2_vec_xor(gf2_word *dst, const gf2_word *src, int words)
+{
+    for (int i = 0; i < words; i++)
+        dst[i] ^= src[i];
+}
+
+static inline int gf2_vec_popcount(const gf2_word *v, int words)
+{
+    int n = 0;
+
+    for (int i = 0; i < words; i++)
+        n += gf2_popcount_word(v[i]);
+
+    return n;
+}
+
+static inline bool gf2_vec_is_zero(const gf2_word *v, int words)
+{
+    for (int i = 0; i < words; i++)
+    {
+        if (v[i])
+            return false;
+    }
+
+    return true;
+}
+
+//
+// index of the first set bit at or after 'from', -1 if there is none
+//
+// usage:
+//     for (int i = gf2_next_set(v, words, 0); i >= 0; i = gf2_next_set(v, words, i + 1))
+//
+static inline int gf2_next_set(const gf2_word *v, int words, int from)
+{
+    int w = from / GF2_WORD_BITS;
+
+    if (w >= words)
+        return -1;
+
+    gf2_word cur = v[w] & (~(gf2_word)0 << (from % GF2_WORD_BITS));
+
+    while (!cur)
+    {
+        if (++w >= words)
+            return -1;
+        cur = v[w];
+    }
+
+    return w * GF2_WORD_BITS + gf2_ctz(cur);
+}
+
+// v <<= 1 on an nbits wide vector, bit nbits-1 falls off the top
+void gf2_vec_shl1(gf2_word *v, int nbits);
+
+//
+// row-major matrix, each row is a vector of 'cols' bits
+//
+struct gf2_matrix
+{
+    int rows;
+    int cols;
+    int words; // words per row
+    gf2_word *bits;
+};
+
+// allocate a zeroed matrix, returns false on failed allocation
+bool gf2_matrix_alloc(gf2_matrix *m, int rows, int cols);
+void gf2_matrix_free(gf2_matrix *m);
+
+static inline gf2_word *gf2_row(gf2_matrix *m, int r)
+{
+    return m->bits + (size_t)r * m->words;
+}
+
+static inline const gf2_word *gf2_row(const gf2_matrix *m, int r)
+{
+    return m->bits + (size_t)r * m->words;
+}
+
+#endif // GF2_H
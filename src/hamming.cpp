@@ -0,0 +1,223 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include "hamming.h"
+#include "parallel.h"
+
+//
+// codeword bits by syndrome: an open addressing table from the syndrome to
+// its run in pos, the bits with that syndrome in ascending order. syndromes
+// are never zero, zero marks a free slot.
+//
+struct syn_index
+{
+    std::vector<gf2_word> keys;
+    std::vector<int> first;
+    std::vector<int> count;
+    std::vector<int> pos;
+    gf2_word mask;
+};
+
+static inline size_t syn_slot(gf2_word v, gf2_word mask)
+{
+    return (size_t)(((v * 0x9e3779b97f4a7c15ull) >> 24) & mask);
+}
+
+static void build_syn_index(const gf2_word *syn, int n, syn_index *ix)
+{
+    std::vector<std::pair<gf2_word, int> > by_syn(n);
+    size_t size = 1;
+
+    while (size < 2 * (size_t)n)
+        size <<= 1;
+
+    ix->mask = size - 1;
+    ix->keys.assign(size, 0);
+    ix->first.assign(size, 0);
+    ix->count.assign(size, 0);
+    ix->pos.resize(n);
+
+    for (int i = 0; i < n; i++)
+        by_syn[i] = std::make_pair(syn[i], i);
+
+    std::sort(by_syn.begin(), by_syn.end());
+
+    for (int i = 0; i < n; i++)
+    {
+        ix->pos[i] = by_syn[i].second;
+
+        if (i && by_syn[i].first == by_syn[i - 1].first)
+            continue;
+
+        size_t h = syn_slot(by_syn[i].first, ix->mask);
+
+        while (ix->keys[h])
+            h = (h + 1) & ix->mask;
+
+        ix->keys[h] = by_syn[i].first;
+        ix->first[h] = i;
+
+        int k = i;
+
+        while (k < n && by_syn[k].first == by_syn[i].first)
+            k++;
+
+        ix->count[h] = k - i;
+    }
+}
+
+// adds 1 to span[d] for every bit d > after with syndrome v
+static inline void count_last_bits(const syn_index *ix, gf2_word v, int after, long long *span)
+{
+    size_t h = syn_slot(v, ix->mask);
+
+    while (ix->keys[h] && ix->keys[h] != v)
+        h = (h + 1) & ix->mask;
+
+    if (!ix->keys[h])
+        return;
+
+    for (int k = ix->first[h] + ix->count[h] - 1; k >= ix->first[h] && ix->pos[k] > after; k--)
+        span[ix->pos[k]]++;
+}
+
+void hd_analyze(int N,
+                const gf2_word *poly,
+                const int *data_lens,
+                int num_lengths,
+                int max_weight,
+                int num_threads,
+                hd_spectrum *r)
+{
+    int n = N + *std::max_element(data_lens, data_lens + num_lengths);
+    std::vector<gf2_word> syn(n);
+
+    // syn[i] = x^i mod g
+    gf2_word f = poly[0] | 1;
+    gf2_word top = (gf2_word)1 << (N - 1);
+    gf2_word mask = N < GF2_WORD_BITS ? ((gf2_word)1 << N) - 1 : ~(gf2_word)0;
+    gf2_word s = 1;
+
+    for (int i = 0; i < n; i++)
+    {
+        syn[i] = s;
+
+        bool carry = (s & top) != 0;
+        s = (s << 1) & mask;
+        if (carry)
+            s ^= f;
+    }
+
+    syn_index ix;
+
+    build_syn_index(&syn[0], n, &ix);
+
+    if (num_threads < 1)
+        num_threads = parallel_default_threads();
+
+    // span[t][w][d]: patterns {0, ..., d} of w bits found by thread t
+    std::vector<std::vector<std::vector<long long> > > span(num_threads,
+                                                            std::vector<std::vector<long long> >(max_weight + 1, std::vector<long long>(n, 0)));
+
+    parallel_for(n - 1, num_threads, [&](int item, int thread)
+                 {
+                     int b = item + 1;
+                     std::vector<std::vector<long long> > &sp = span[thread];
+
+                     // {0, b}
+                     if (syn[b] == syn[0])
+                         sp[2][b]++;
+
+                     // {0, b, d}
+                     if (max_weight >= 3)
+                         count_last_bits(&ix, syn[0] ^ syn[b], b, &sp[3][0]);
+
+                     // {0, b, c, d}
+                     for (int c = b + 1; max_weight >= 4 && c < n; c++)
+                         count_last_bits(&ix, syn[0] ^ syn[b] ^ syn[c], c, &sp[4][0]);
+                 });
+
+    for (int k = 0; k < num_lengths; k++)
+    {
+        int len = data_lens[k] + N;
+
+        r[k].data_len = data_lens[k];
+        r[k].hd = 0;
+
+        for (int w = 0; w <= HD_WEIGHT_MAX; w++)
+            r[k].weights[w] = 0;
+
+        // x^i mod g is never zero, so no 1 bit pattern goes undetected
+        for (int w = 2; w <= max_weight; w++)
+        {
+            for (int t = 0; t < num_threads; t++)
+            {
+                for (int d = 1; d < len; d++)
+                    r[k].weights[w] += span[t][w][d] * (len - d);
+            }
+
+            if (!r[k].hd && r[k].weights[w])
+                r[k].hd = w;
+        }
+    }
+} // hd_analyze
+
+bool hd_better(const hd_spectrum *a, const hd_spectrum *b, int num_lengths, int max_weight)
+{
+    for (int k = 0; k < num_lengths; k++)
+    {
+        int hd_a = a[k].hd ? a[k].hd : max_weight + 1;
+        int hd_b = b[k].hd ? b[k].hd : max_weight + 1;
+
+        if (hd_a != hd_b)
+            return hd_a > hd_b;
+
+        if (a[k].hd && a[k].weights[hd_a] != b[k].weights[hd_b])
+            return a[k].weights[hd_a] < b[k].weights[hd_b];
+    }
+
+    return false;
+}
+
+void print_hd_spectrum(emit_buf *out, int rank, const char *poly_str, const hd_spectrum *r, int max_weight)
+{
+    emit_fmt(out, "%6d  %-18s %8d  ", rank, poly_str, r->data_len);
+
+    if (r->hd)
+        emit_fmt(out, "%3d", r->hd);
+    else
+        emit_fmt(out, ">%2d", max_weight);
+
+    for (int w = 2; w <= max_weight; w++)
+        emit_fmt(out, "  %14lld", r->weights[w]);
+
+    EMIT_LIT(out, "\n");
+}
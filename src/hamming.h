@@ -0,0 +1,78 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HAMMING_H
+#define HAMMING_H
+
+#include "emit.h"
+#include "gf2.h"
+
+//
+// error detection strength of a CRC polynomial
+//
+// a frame of data_len bits and its N CRC bits is a codeword of the code
+// generated by g = x^N + (poly|1), the polynomial the HDL implements. an
+// error pattern goes undetected iff g divides it, i.e. the syndromes
+// x^i mod g of its bits XOR to zero; INIT and OUTPUT_XOR do not change that.
+// weights[w] counts the undetected patterns of w bits, the Hamming distance
+// is the lowest w with weights[w] > 0.
+//
+// g has the +1 term, so a pattern is x^a times one that starts at bit 0:
+// only the patterns {0, b, ...} are searched, with a hash lookup for the
+// last bit, and a pattern spanning d bits is counted n-d times in an n bit
+// codeword. the syndromes of N <= 64 bit polynomials are single words and
+// the first bits b are spread over the threads.
+//
+#define HD_POLY_WIDTH_MAX 64
+#define HD_WEIGHT_MAX 4
+
+struct hd_spectrum
+{
+    int data_len;
+    int hd; // 0 = no undetected error up to max_weight bits
+    long long weights[HD_WEIGHT_MAX + 1];
+};
+
+// r[k] for the data lengths data_lens[k], weights 1..max_weight
+void hd_analyze(int N,
+                const gf2_word *poly,
+                const int *data_lens,
+                int num_lengths,
+                int max_weight,
+                int num_threads,
+                hd_spectrum *r);
+
+// ranking of two polynomials over the same lengths: the higher Hamming
+// distance at the first length that differs, then the fewer undetected
+// errors of that weight
+bool hd_better(const hd_spectrum *a, const hd_spectrum *b, int num_lengths, int max_weight);
+
+// one table line per polynomial and length
+void print_hd_spectrum(emit_buf *out, int rank, const char *poly_str, const hd_spectrum *r, int max_weight);
+
+#endif // HAMMING_H
@@ -0,0 +1,121 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "cost.h"
+#include "lanes.h"
+
+bool plan_lanes(const gf2_matrix *eq, int N, int M, int lanes, crc_lanes *p)
+{
+    int W = M / lanes;
+
+    p->lanes = lanes;
+    p->lane_width = W;
+    p->combine.bits = NULL;
+
+    if (!gf2_matrix_alloc(&p->lane_rows, N, N + W))
+        return false;
+
+    if (!gf2_matrix_alloc(&p->combine, N, N + M + lanes * N))
+    {
+        gf2_matrix_free(&p->lane_rows);
+        return false;
+    }
+
+    for (int n2 = 0; n2 < N; n2++)
+    {
+        const gf2_word *row = gf2_row(eq, n2);
+        gf2_word *lane_row = gf2_row(&p->lane_rows, n2);
+        gf2_word *combine_row = gf2_row(&p->combine, n2);
+
+        for (int t = gf2_next_set(row, eq->words, 0); t >= 0 && t < N + W; t = gf2_next_set(row, eq->words, t + 1))
+        {
+            if (t < N)
+                gf2_set(combine_row, t); // A^M, as in the flat equations
+            else
+                gf2_set(lane_row, t);
+        }
+
+        for (int l = 0; l < lanes; l++)
+        {
+            int k = l * W;
+
+            // column i of A^k, row n2
+            for (int i = 0; i < N; i++)
+            {
+                if (i + k < N ? i + k == n2 : gf2_get(row, N + k - (N - i)))
+                    gf2_set(combine_row, N + M + l * N + i);
+            }
+        }
+    }
+
+    return true;
+}
+
+void free_lanes(crc_lanes *p)
+{
+    gf2_matrix_free(&p->lane_rows);
+    gf2_matrix_free(&p->combine);
+}
+
+void report_lanes(FILE *fp, const char *name, const gf2_matrix *eq, int N, const crc_lanes *p)
+{
+    int max_flat = 0;
+    int max_lane = 0;
+    int max_combine = 0;
+    long long flat_gates = 0;
+    long long lane_gates = 0;
+    long long combine_gates = 0;
+
+    for (int n2 = 0; n2 < N; n2++)
+    {
+        int flat = gf2_vec_popcount(gf2_row(eq, n2), eq->words);
+        int lane = gf2_vec_popcount(gf2_row(&p->lane_rows, n2), p->lane_rows.words);
+        int combine = gf2_vec_popcount(gf2_row(&p->combine, n2), p->combine.words);
+
+        if (max_flat < flat)
+            max_flat = flat;
+        if (max_lane < lane)
+            max_lane = lane;
+        if (max_combine < combine)
+            max_combine = combine;
+
+        flat_gates += flat > 1 ? flat - 1 : 0;
+        lane_gates += lane > 1 ? lane - 1 : 0;
+        combine_gates += combine > 1 ? combine - 1 : 0;
+    }
+
+    // the lane CRCs are registered, each stage has a clock of its own
+    fprintf(fp, "%s: %d lanes of %d bits: lane stage max %d inputs, %d xor2 levels, %d lut6 levels\n",
+            name, p->lanes, p->lane_width, max_lane, xor2_levels(max_lane), lut6_levels(max_lane));
+
+    fprintf(fp, "%s: combine and feedback stage max %d inputs, %d xor2 levels, %d lut6 levels, latency 1, %lld xor2 gates\n",
+            name, max_combine, xor2_levels(max_combine), lut6_levels(max_combine), p->lanes * lane_gates + combine_gates);
+
+    fprintf(fp, "%s: flat: max %d inputs, %d xor2 levels, %d lut6 levels, %lld xor2 gates\n",
+            name, max_flat, xor2_levels(max_flat), lut6_levels(max_flat), flat_gates);
+}
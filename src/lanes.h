@@ -0,0 +1,78 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef LANES_H
+#define LANES_H
+
+#include <stdio.h>
+
+#include "gf2.h"
+
+//
+// split-and-combine data path for wide buses
+//
+// data_in_inv_res is cut into L lanes of W = M/L bits, lane l holding bits
+// l*W..l*W+W-1. lane l is shifted in after lanes l+1..L-1, so its data terms
+// are those of a W bit beat followed by l*W zero bits:
+//
+//   lfsr_c = A^M * lfsr_q ^ sum over l of A^(l*W) * lane_crc_l
+//   lane_crc_l = D_W * (lane l)
+//
+// every lane computes its partial CRC with the same W bit data matrix D_W,
+// and the combine matrices A^(l*W) merge the partial CRCs with the lfsr_q
+// terms. all of them are columns of the flat matrix: D_W is data columns
+// 0..W-1, and column i of A^k is e[i+k] if i+k < N, else data column k-(N-i).
+//
+// the lane CRCs are registered, so the lane stage and the combine stage with
+// the lfsr_q feedback each get a clock, and lfsr_q follows data_in one clock
+// later as with a one stage --pipeline.
+//
+struct crc_lanes
+{
+    int lanes;
+    int lane_width;
+
+    // N x (N+W), data columns only: lane_crc_l[n2] reads data_in_inv_res[l*W+j]
+    // for column N+j
+    gf2_matrix lane_rows;
+
+    // N x (N+M+L*N): lfsr_q columns, no data columns, then lane_crc_l[i] at
+    // column N+M+l*N+i
+    gf2_matrix combine;
+};
+
+// from the flat matrix eq (N state columns, then M data columns), returns
+// false on failed allocation. lanes must divide M
+bool plan_lanes(const gf2_matrix *eq, int N, int M, int lanes, crc_lanes *p);
+void free_lanes(crc_lanes *p);
+
+// inputs, XOR2 and LUT6 levels of the lane stage and of the combine and
+// feedback stage, the XOR2 gates, and the same for the flat equations
+void report_lanes(FILE *fp, const char *name, const gf2_matrix *eq, int N, const crc_lanes *p);
+
+#endif // LANES_H
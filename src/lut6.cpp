@@ -0,0 +1,392 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "cost.h"
+#include "lut6.h"
+
+#include <algorithm>
+
+//
+// the search runs on the transposed matrix like xor_cse(): every signal is a
+// column vector over the equations. per equation the signals are either old,
+// from a lower level and free to be packed, or new, made at this level. an
+// equation with o old and n new signals still fits in the levels left as long
+// as n + ceil(o/6) <= 6^(levels left), a shared group only goes to the
+// equations it does not push over that.
+//
+bool map_lut6(const gf2_matrix *eq, crc_lut6 *p)
+{
+    int words = GF2_WORDS(eq->rows);
+    int num_cols = eq->cols;
+    int max_terms = 0;
+
+    std::vector<gf2_word> cols((size_t)num_cols * words, 0);
+    std::vector<int> level(num_cols, 0);
+
+    p->leaves = eq->cols;
+    p->inputs.clear();
+    p->level_start.clear();
+    p->num_shared = 0;
+    p->rows.bits = NULL;
+
+    for (int r = 0; r < eq->rows; r++)
+    {
+        const gf2_word *row = gf2_row(eq, r);
+
+        for (int c = gf2_next_set(row, eq->words, 0); c >= 0; c = gf2_next_set(row, eq->words, c + 1))
+            gf2_set(&cols[(size_t)c * words], r);
+
+        max_terms = std::max(max_terms, gf2_vec_popcount(row, eq->words));
+    }
+
+    p->levels = lut6_levels(max_terms);
+
+    std::vector<int> old_cnt(eq->rows);
+    std::vector<int> new_cnt(eq->rows);
+    std::vector<int> best_cnt;
+    std::vector<int> best_partner;
+    std::vector<gf2_word> common(words);
+    std::vector<gf2_word> grown(words);
+
+    // a new signal over inputs 'group' for the equations in 'used'
+    auto add_signal = [&](const std::vector<int> &group, const gf2_word *used, int lv)
+    {
+        for (size_t i = 0; i < group.size(); i++)
+        {
+            for (int w = 0; w < words; w++)
+                cols[(size_t)group[i] * words + w] &= ~used[w];
+        }
+
+        for (int r = gf2_next_set(used, words, 0); r >= 0; r = gf2_next_set(used, words, r + 1))
+        {
+            old_cnt[r] -= (int)group.size();
+            new_cnt[r]++;
+        }
+
+        cols.insert(cols.end(), used, used + words);
+        level.push_back(lv);
+        p->inputs.push_back(group);
+        std::sort(p->inputs.back().begin(), p->inputs.back().end());
+        num_cols++;
+    };
+
+    for (int lv = 1; lv < p->levels; lv++)
+    {
+        long long cap = 1;
+
+        for (int l = lv; l < p->levels; l++)
+            cap *= LUT6_INPUTS;
+
+        p->level_start.push_back((int)p->inputs.size());
+
+        for (int r = 0; r < eq->rows; r++)
+        {
+            old_cnt[r] = 0;
+            new_cnt[r] = 0;
+        }
+
+        for (int c = 0; c < num_cols; c++)
+        {
+            const gf2_word *col = &cols[(size_t)c * words];
+
+            for (int r = gf2_next_set(col, words, 0); r >= 0; r = gf2_next_set(col, words, r + 1))
+                old_cnt[r]++;
+        }
+
+        // shared groups out of the signals below this level
+        std::vector<int> active;
+
+        for (int c = 0; c < num_cols; c++)
+        {
+            if (gf2_vec_popcount(&cols[(size_t)c * words], words) > 1)
+                active.push_back(c);
+        }
+
+        best_cnt.assign(num_cols, 0);
+        best_partner.assign(num_cols, -1);
+
+        // count of equations that use a and the set in v
+        auto shared = [&](int a, const gf2_word *v)
+        {
+            const gf2_word *va = &cols[(size_t)a * words];
+            int n = 0;
+
+            for (int w = 0; w < words; w++)
+                n += gf2_popcount_word(va[w] & v[w]);
+
+            return n;
+        };
+
+        auto rescan = [&](int a)
+        {
+            best_cnt[a] = 0;
+            best_partner[a] = -1;
+
+            for (size_t i = 0; i < active.size(); i++)
+            {
+                int b = active[i];
+                int n;
+
+                if (b != a && (n = shared(a, &cols[(size_t)b * words])) > best_cnt[a])
+                {
+                    best_cnt[a] = n;
+                    best_partner[a] = b;
+                }
+            }
+        };
+
+        for (size_t i = 0; i < active.size(); i++)
+            rescan(active[i]);
+
+        for (;;)
+        {
+            int a = -1;
+
+            for (size_t i = 0; i < active.size(); i++)
+            {
+                int c = active[i];
+
+                if (best_cnt[c] > 1 && (a < 0 || best_cnt[c] > best_cnt[a]))
+                    a = c;
+            }
+
+            if (a < 0)
+                break;
+
+            std::vector<int> group;
+
+            group.push_back(a);
+            group.push_back(best_partner[a]);
+
+            for (int w = 0; w < words; w++)
+                common[w] = cols[(size_t)a * words + w] & cols[(size_t)group[1] * words + w];
+
+            // k inputs shared by e equations save (k-1)*(e-1) inputs
+            int users = gf2_vec_popcount(&common[0], words);
+
+            while ((int)group.size() < LUT6_INPUTS)
+            {
+                int k = (int)group.size();
+                int best = -1;
+                int best_users = 0;
+
+                for (size_t i = 0; i < active.size(); i++)
+                {
+                    int c = active[i];
+                    int n;
+
+                    if (std::find(group.begin(), group.end(), c) == group.end() &&
+                        (n = shared(c, &common[0])) > best_users)
+                    {
+                        best = c;
+                        best_users = n;
+                    }
+                }
+
+                if (best < 0 || k * (best_users - 1) <= (k - 1) * (users - 1))
+                    break;
+
+                group.push_back(best);
+                users = best_users;
+
+                for (int w = 0; w < words; w++)
+                    common[w] &= cols[(size_t)best * words + w];
+            }
+
+            int k = (int)group.size();
+
+            gf2_vec_copy(&grown[0], &common[0], words);
+
+            for (int r = gf2_next_set(&grown[0], words, 0); r >= 0; r = gf2_next_set(&grown[0], words, r + 1))
+            {
+                long long packed = new_cnt[r] + 1 + (old_cnt[r] - k + LUT6_INPUTS - 1) / LUT6_INPUTS;
+
+                if (packed > cap || old_cnt[r] + new_cnt[r] <= LUT6_INPUTS)
+                    gf2_clear(&common[0], r);
+            }
+
+            // the best group no longer fits, the rest is packed per equation
+            if (gf2_vec_popcount(&common[0], words) < 2)
+                break;
+
+            add_signal(group, &common[0], lv);
+            p->num_shared++;
+            best_cnt.push_back(0);
+            best_partner.push_back(-1);
+
+            // drop the inputs that are no longer shared
+            size_t kept = 0;
+
+            for (size_t i = 0; i < active.size(); i++)
+            {
+                int c = active[i];
+
+                if (std::find(group.begin(), group.end(), c) == group.end() ||
+                    gf2_vec_popcount(&cols[(size_t)c * words], words) > 1)
+                    active[kept++] = c;
+                else
+                    best_cnt[c] = 0;
+            }
+
+            active.resize(kept);
+
+            for (size_t i = 0; i < active.size(); i++)
+            {
+                int c = active[i];
+
+                if (std::find(group.begin(), group.end(), c) != group.end() ||
+                    std::find(group.begin(), group.end(), best_partner[c]) != group.end())
+                    rescan(c);
+            }
+        }
+
+        // then per equation whatever it still needs to fit, from its old
+        // signals in column order
+        std::vector<std::vector<int>> old_signals(eq->rows);
+        int first_new = num_cols - (int)(p->inputs.size() - p->level_start.back());
+
+        for (int c = 0; c < first_new; c++)
+        {
+            const gf2_word *col = &cols[(size_t)c * words];
+
+            for (int r = gf2_next_set(col, words, 0); r >= 0; r = gf2_next_set(col, words, r + 1))
+                old_signals[r].push_back(c);
+        }
+
+        std::vector<gf2_word> used(words);
+
+        for (int r = 0; r < eq->rows; r++)
+        {
+            long long need = old_cnt[r] + new_cnt[r] - cap;
+            size_t next = 0;
+
+            gf2_vec_zero(&used[0], words);
+            gf2_set(&used[0], r);
+
+            while (need > 0)
+            {
+                int k = (int)std::min<long long>(LUT6_INPUTS, need + 1);
+                std::vector<int> group(old_signals[r].begin() + next, old_signals[r].begin() + next + k);
+
+                add_signal(group, &used[0], lv);
+                next += k;
+                need -= k - 1;
+            }
+        }
+    }
+
+    p->level_start.push_back((int)p->inputs.size());
+
+    // back to one row per equation
+    if (!gf2_matrix_alloc(&p->rows, eq->rows, num_cols))
+        return false;
+
+    for (int c = 0; c < num_cols; c++)
+    {
+        const gf2_word *col = &cols[(size_t)c * words];
+
+        for (int r = gf2_next_set(col, words, 0); r >= 0; r = gf2_next_set(col, words, r + 1))
+            gf2_set(gf2_row(&p->rows, r), c);
+    }
+
+    return true;
+
+} // map_lut6
+
+void free_lut6(crc_lut6 *p)
+{
+    gf2_matrix_free(&p->rows);
+}
+
+bool compose_lut6(const crc_lut6 *p, gf2_matrix *eq)
+{
+    int words = GF2_WORDS(p->leaves);
+    std::vector<gf2_word> expand(p->inputs.size() * words, 0);
+
+    // signals only read lower levels, so in order every input is done
+    for (size_t k = 0; k < p->inputs.size(); k++)
+    {
+        gf2_word *v = &expand[k * words];
+
+        for (size_t i = 0; i < p->inputs[k].size(); i++)
+        {
+            int c = p->inputs[k][i];
+
+            if (c < p->leaves)
+                gf2_flip(v, c);
+            else
+                gf2_vec_xor(v, &expand[(size_t)(c - p->leaves) * words], words);
+        }
+    }
+
+    if (!gf2_matrix_alloc(eq, p->rows.rows, p->leaves))
+        return false;
+
+    for (int r = 0; r < p->rows.rows; r++)
+    {
+        const gf2_word *row = gf2_row(&p->rows, r);
+        gf2_word *out = gf2_row(eq, r);
+
+        for (int c = gf2_next_set(row, p->rows.words, 0); c >= 0; c = gf2_next_set(row, p->rows.words, c + 1))
+        {
+            if (c < p->leaves)
+                gf2_flip(out, c);
+            else
+                gf2_vec_xor(out, &expand[(size_t)(c - p->leaves) * words], words);
+        }
+    }
+
+    return true;
+}
+
+void report_lut6(FILE *fp, const char *name, const gf2_matrix *eq, const crc_lut6 *p)
+{
+    long long flat_luts = 0;
+    int max_flat = 0;
+    int top_luts = 0;
+
+    for (int r = 0; r < eq->rows; r++)
+    {
+        int n = gf2_vec_popcount(gf2_row(eq, r), eq->words);
+
+        flat_luts += lut6_count(n);
+        max_flat = std::max(max_flat, n);
+        top_luts += lut6_count(gf2_vec_popcount(gf2_row(&p->rows, r), p->rows.words));
+    }
+
+    fprintf(fp, "%s: lut6 mapped: %lld luts (%d shared), %d levels:",
+            name, (long long)p->inputs.size() + top_luts, p->num_shared, p->levels);
+
+    for (int l = 0; l + 1 < (int)p->level_start.size(); l++)
+        fprintf(fp, " %d", p->level_start[l + 1] - p->level_start[l]);
+
+    fprintf(fp, " %d luts\n", top_luts);
+
+    fprintf(fp, "%s: flat: max %d inputs, %lld luts, %d levels\n",
+            name, max_flat, flat_luts, lut6_levels(max_flat));
+}
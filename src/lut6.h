@@ -0,0 +1,80 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef LUT6_H
+#define LUT6_H
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "gf2.h"
+
+//
+// LUT6 technology mapping of a set of XOR equations
+//
+// every equation becomes a tree of 6-input XORs with the same number of levels
+// L, the fewest that fit the widest equation. level by level the inputs of
+// all equations are packed into new signals of up to 6 inputs: first groups
+// that several equations have in common, grown from the most shared pair as
+// long as that saves more inputs than it loses equations, then per equation
+// just enough groups so that it still fits in the levels left. the last level
+// is the equation itself, an XOR of at most 6 signals.
+//
+// the new signals are numbered in level order, signal k is column leaves+k of
+// rows. a group only reads signals of lower levels, so every path from an
+// input to an equation goes through at most L LUTs. per equation packing
+// leaves old signals that skip levels, so shorter paths remain.
+//
+struct crc_lut6
+{
+    int leaves; // input columns of the equations
+    int levels;
+
+    // inputs[k] of new signal k: input columns, or leaves+j for new signal j
+    std::vector<std::vector<int>> inputs;
+
+    // new signals of level l+1 are level_start[l]..level_start[l+1]-1
+    std::vector<int> level_start;
+    int num_shared; // of them read by more than one signal
+
+    // eq->rows x (leaves + inputs.size()), at most 6 columns set in a row
+    gf2_matrix rows;
+};
+
+// from the rows of eq, returns false on failed allocation
+bool map_lut6(const gf2_matrix *eq, crc_lut6 *p);
+void free_lut6(crc_lut6 *p);
+
+// the leaves columns matrix the mapped equations compute, for checking them
+bool compose_lut6(const crc_lut6 *p, gf2_matrix *eq);
+
+// LUTs and levels of the mapping against one LUT6 tree per flat equation
+void report_lut6(FILE *fp, const char *name, const gf2_matrix *eq, const crc_lut6 *p);
+
+#endif // LUT6_H
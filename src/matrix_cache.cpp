@@ -0,0 +1,302 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+
+#if defined(_WIN32)
+#include <direct.h>
+#include <process.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "matrix_cache.h"
+
+static const char matrix_magic[8] = {'C', 'R', 'C', 'M', 'T', 'X', 0, 0};
+
+struct matrix_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_bytes;
+    uint32_t poly_width;
+    uint32_t data_width;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t words;
+    uint32_t reserved0;
+    uint64_t payload_bytes;
+    uint64_t checksum;
+    uint64_t reserved1;
+};
+
+//
+// 64-bit multiply-rotate hash over whole words, fast enough to check a file
+// on every load. the payload checksum in python, with M = 2^64 - 1:
+//
+//     h = 0x9e3779b97f4a7c15
+//     for w in payload_words: h = (rotl64(h ^ w, 31) * 0xff51afd7ed558ccd) & M
+//     h ^= h >> 33
+//
+#define MATRIX_HASH_SEED 0x9e3779b97f4a7c15ull
+
+static uint64_t hash_words(uint64_t h, const gf2_word *v, size_t words)
+{
+    for (size_t i = 0; i < words; i++)
+    {
+        h ^= v[i];
+        h = (h << 31) | (h >> 33);
+        h *= 0xff51afd7ed558ccdull;
+    }
+
+    return h;
+}
+
+static uint64_t hash_final(uint64_t h)
+{
+    return h ^ (h >> 33);
+}
+
+static void fill_header(matrix_file_header *h, int lfsr_poly_size, int num_data_bits)
+{
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, matrix_magic, sizeof(matrix_magic));
+    h->version = MATRIX_FILE_VERSION;
+    h->header_bytes = MATRIX_FILE_HEADER_BYTES;
+    h->poly_width = (uint32_t)lfsr_poly_size;
+    h->data_width = (uint32_t)num_data_bits;
+    h->rows = (uint32_t)lfsr_poly_size;
+    h->cols = (uint32_t)(lfsr_poly_size + num_data_bits);
+    h->words = (uint32_t)GF2_WORDS(lfsr_poly_size + num_data_bits);
+    h->payload_bytes = sizeof(gf2_word) * (GF2_WORDS(lfsr_poly_size) + (uint64_t)h->rows * h->words);
+}
+
+// the payload is the polynomial followed by the rows
+static uint64_t payload_checksum(int lfsr_poly_size, const gf2_word *lfsr_poly, const gf2_matrix *matrix)
+{
+    uint64_t h = hash_words(MATRIX_HASH_SEED, lfsr_poly, GF2_WORDS(lfsr_poly_size));
+
+    return hash_final(hash_words(h, matrix->bits, (size_t)matrix->rows * matrix->words));
+}
+
+std::string matrix_cache_path(const char *dir, int lfsr_poly_size, int num_data_bits, const gf2_word *lfsr_poly)
+{
+    gf2_word params[3] = {MATRIX_FILE_VERSION, (gf2_word)lfsr_poly_size, (gf2_word)num_data_bits};
+    uint64_t key = hash_final(hash_words(hash_words(MATRIX_HASH_SEED, params, 3), lfsr_poly, GF2_WORDS(lfsr_poly_size)));
+    char name[80];
+
+    snprintf(name, sizeof(name), "crc-%d-%d-%016llx.mtx", lfsr_poly_size, num_data_bits, (unsigned long long)key);
+
+    std::string path(dir);
+
+    if (!path.empty() && path[path.size() - 1] != '/' && path[path.size() - 1] != '\\')
+        path += '/';
+
+    return path + name;
+}
+
+bool matrix_file_map(const char *path,
+                     int lfsr_poly_size,
+                     int num_data_bits,
+                     const gf2_word *lfsr_poly,
+                     gf2_matrix *matrix,
+                     matrix_map *map)
+{
+    memset(map, 0, sizeof(*map));
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER size;
+
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart < MATRIX_FILE_HEADER_BYTES)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void *base = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+
+    if (!base)
+    {
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    map->base = base;
+    map->size = (size_t)size.QuadPart;
+    map->file = file;
+    map->mapping = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &st) || st.st_size < MATRIX_FILE_HEADER_BYTES)
+    {
+        close(fd);
+        return false;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (base == MAP_FAILED)
+        return false;
+
+    map->base = base;
+    map->size = (size_t)st.st_size;
+#endif
+
+    matrix_file_header want;
+    const matrix_file_header *have = (const matrix_file_header *)map->base;
+
+    fill_header(&want, lfsr_poly_size, num_data_bits);
+
+    const gf2_word *payload = (const gf2_word *)((const char *)map->base + MATRIX_FILE_HEADER_BYTES);
+    size_t poly_words = GF2_WORDS(lfsr_poly_size);
+
+    bool ok = map->size == MATRIX_FILE_HEADER_BYTES + want.payload_bytes &&
+              !memcmp(have->magic, want.magic, sizeof(want.magic)) &&
+              have->version == want.version &&
+              have->header_bytes == want.header_bytes &&
+              have->poly_width == want.poly_width &&
+              have->data_width == want.data_width &&
+              have->rows == want.rows &&
+              have->cols == want.cols &&
+              have->words == want.words &&
+              have->payload_bytes == want.payload_bytes &&
+              !memcmp(payload, lfsr_poly, sizeof(gf2_word) * poly_words);
+
+    if (ok)
+    {
+        matrix->rows = (int)want.rows;
+        matrix->cols = (int)want.cols;
+        matrix->words = (int)want.words;
+        matrix->bits = (gf2_word *)(payload + poly_words);
+
+        ok = have->checksum == payload_checksum(lfsr_poly_size, lfsr_poly, matrix);
+    }
+
+    if (!ok)
+    {
+        matrix_unmap(map);
+        matrix->bits = NULL;
+    }
+
+    return ok;
+} // matrix_file_map
+
+void matrix_unmap(matrix_map *map)
+{
+    if (!map->base)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(map->base);
+    CloseHandle((HANDLE)map->mapping);
+    CloseHandle((HANDLE)map->file);
+#else
+    munmap(map->base, map->size);
+#endif
+
+    memset(map, 0, sizeof(*map));
+}
+
+bool matrix_file_write(const char *path,
+                       int lfsr_poly_size,
+                       int num_data_bits,
+                       const gf2_word *lfsr_poly,
+                       const gf2_matrix *matrix)
+{
+    static std::atomic<unsigned> serial(0);
+    matrix_file_header h;
+    char suffix[48];
+
+    fill_header(&h, lfsr_poly_size, num_data_bits);
+    h.checksum = payload_checksum(lfsr_poly_size, lfsr_poly, matrix);
+
+    // concurrent writers of one entry, threads or processes, each use their
+    // own temporary and the last rename wins with identical content
+#if defined(_WIN32)
+    snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", (int)_getpid(), serial++);
+#else
+    snprintf(suffix, sizeof(suffix), ".%d.%u.tmp", (int)getpid(), serial++);
+#endif
+
+    std::string tmp_path = std::string(path) + suffix;
+    FILE *fp = fopen(tmp_path.c_str(), "wb");
+
+    if (!fp)
+        return false;
+
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+              fwrite(lfsr_poly, sizeof(gf2_word), GF2_WORDS(lfsr_poly_size), fp) == (size_t)GF2_WORDS(lfsr_poly_size) &&
+              fwrite(matrix->bits, sizeof(gf2_word) * matrix->words, matrix->rows, fp) == (size_t)matrix->rows;
+
+    if (fclose(fp))
+        ok = false;
+
+#if defined(_WIN32)
+    if (ok && !MoveFileExA(tmp_path.c_str(), path, MOVEFILE_REPLACE_EXISTING))
+#else
+    if (ok && rename(tmp_path.c_str(), path))
+#endif
+        ok = false;
+
+    if (!ok)
+        remove(tmp_path.c_str());
+
+    return ok;
+} // matrix_file_write
+
+bool matrix_cache_mkdir(const char *dir)
+{
+#if defined(_WIN32)
+    return !_mkdir(dir) || errno == EEXIST;
+#else
+    return !mkdir(dir, 0777) || errno == EEXIST;
+#endif
+}
@@ -0,0 +1,104 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MATRIX_CACHE_H
+#define MATRIX_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "gf2.h"
+
+//
+// binary matrix files: the --cache entries and --export-matrix output
+//
+// little endian, every field 64-bit aligned so the rows can be used in place
+// from a read-only mapping:
+//
+//     0  char[8]   magic "CRCMTX\0\0"
+//     8  uint32    format version, MATRIX_FILE_VERSION
+//    12  uint32    header bytes, 64
+//    16  uint32    poly_width N
+//    20  uint32    data_width M
+//    24  uint32    rows, N
+//    28  uint32    columns, N+M
+//    32  uint32    64-bit words per row, (N+M+63)/64
+//    36  uint32    0
+//    40  uint64    payload bytes
+//    48  uint64    checksum of the payload, see matrix_cache.cpp
+//    56  uint64    0
+//    64  uint64[(N+63)/64]     the polynomial, bit i of word i/64 is x^i
+//        uint64[rows][words]   row n2 is lfsr_c[n2]: bit n1 selects lfsr_q[n1],
+//                              bit N+m1 data_in_inv_res[m1]
+//
+// bits are numbered as in gf2.h, bit i of a row is bit i%64 of word i/64.
+//
+#define MATRIX_FILE_VERSION 1
+#define MATRIX_FILE_HEADER_BYTES 64
+
+// a file mapped read-only, base NULL when nothing is mapped
+struct matrix_map
+{
+    void *base;
+    size_t size;
+#if defined(_WIN32)
+    void *file;
+    void *mapping;
+#endif
+};
+
+// the cache entry of a polynomial and data width, named after its content
+std::string matrix_cache_path(const char *dir, int lfsr_poly_size, int num_data_bits, const gf2_word *lfsr_poly);
+
+//
+// map a matrix file and check it holds the equations of this polynomial and
+// data width. on success matrix->bits points into the mapping, which stays
+// valid until matrix_unmap(); a missing, stale or damaged file returns false.
+//
+bool matrix_file_map(const char *path,
+                     int lfsr_poly_size,
+                     int num_data_bits,
+                     const gf2_word *lfsr_poly,
+                     gf2_matrix *matrix,
+                     matrix_map *map);
+
+void matrix_unmap(matrix_map *map);
+
+// write the matrix file through a temporary, returns false on failure
+bool matrix_file_write(const char *path,
+                       int lfsr_poly_size,
+                       int num_data_bits,
+                       const gf2_word *lfsr_poly,
+                       const gf2_matrix *matrix);
+
+// create the cache directory if it does not exist yet
+bool matrix_cache_mkdir(const char *dir);
+
+#endif // MATRIX_CACHE_H
@@ -0,0 +1,141 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <string.h>
+
+#include "matrix_lru.h"
+
+static size_t matrix_bytes(const gf2_matrix *m)
+{
+    return (size_t)m->rows * m->words * sizeof(gf2_word);
+}
+
+static bool entry_matches(const matrix_lru_entry *e, int lfsr_poly_size, int num_data_bits, const gf2_word *lfsr_poly)
+{
+    return e->lfsr_poly_size == lfsr_poly_size &&
+           e->num_data_bits == num_data_bits &&
+           !memcmp(&e->lfsr_poly[0], lfsr_poly, e->lfsr_poly.size() * sizeof(gf2_word));
+}
+
+void matrix_lru_init(matrix_lru *c, size_t max_bytes)
+{
+    c->max_bytes = max_bytes;
+    c->bytes = 0;
+    c->entries.clear();
+    c->hits = 0;
+    c->misses = 0;
+}
+
+bool matrix_lru_get(matrix_lru *c,
+                    int lfsr_poly_size,
+                    int num_data_bits,
+                    const gf2_word *lfsr_poly,
+                    gf2_matrix *matrix)
+{
+    std::shared_ptr<matrix_lru_entry> hit;
+
+    {
+        std::lock_guard<std::mutex> guard(c->lock);
+
+        for (std::list<std::shared_ptr<matrix_lru_entry> >::iterator it = c->entries.begin(); it != c->entries.end(); ++it)
+        {
+            if (entry_matches(it->get(), lfsr_poly_size, num_data_bits, lfsr_poly))
+            {
+                hit = *it;
+                c->entries.splice(c->entries.begin(), c->entries, it);
+                break;
+            }
+        }
+    }
+
+    if (!hit)
+    {
+        c->misses++;
+        return false;
+    }
+
+    if (!gf2_matrix_alloc(matrix, hit->matrix.rows, hit->matrix.cols))
+        return false;
+
+    memcpy(matrix->bits, hit->matrix.bits, matrix_bytes(matrix));
+    c->hits++;
+
+    return true;
+}
+
+bool matrix_lru_put(matrix_lru *c,
+                    int lfsr_poly_size,
+                    int num_data_bits,
+                    const gf2_word *lfsr_poly,
+                    const gf2_matrix *matrix)
+{
+    size_t bytes = matrix_bytes(matrix);
+
+    // larger than the whole cache, it would only flush the other entries
+    if (bytes > c->max_bytes)
+        return true;
+
+    std::shared_ptr<matrix_lru_entry> e(new matrix_lru_entry);
+
+    e->lfsr_poly_size = lfsr_poly_size;
+    e->num_data_bits = num_data_bits;
+    e->lfsr_poly.assign(lfsr_poly, lfsr_poly + GF2_WORDS(lfsr_poly_size));
+
+    if (!gf2_matrix_alloc(&e->matrix, matrix->rows, matrix->cols))
+        return false;
+
+    memcpy(e->matrix.bits, matrix->bits, bytes);
+
+    std::lock_guard<std::mutex> guard(c->lock);
+
+    // another request may have built the same matrix meanwhile
+    for (std::list<std::shared_ptr<matrix_lru_entry> >::iterator it = c->entries.begin(); it != c->entries.end(); ++it)
+    {
+        if (entry_matches(it->get(), lfsr_poly_size, num_data_bits, lfsr_poly))
+            return true;
+    }
+
+    while (!c->entries.empty() && c->bytes + bytes > c->max_bytes)
+    {
+        c->bytes -= matrix_bytes(&c->entries.back()->matrix);
+        c->entries.pop_back();
+    }
+
+    c->entries.push_front(e);
+    c->bytes += bytes;
+
+    return true;
+}
+
+void matrix_lru_size(matrix_lru *c, int *entries, size_t *bytes)
+{
+    std::lock_guard<std::mutex> guard(c->lock);
+
+    *entries = (int)c->entries.size();
+    *bytes = c->bytes;
+}
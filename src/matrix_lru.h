@@ -0,0 +1,88 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MATRIX_LRU_H
+#define MATRIX_LRU_H
+
+#include <stddef.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "gf2.h"
+
+//
+// in-memory cache of built matrices for the server, least recently used
+// entries are dropped once the matrices take more than max_bytes. entries
+// are shared and never change, so a hit is copied out without the lock.
+//
+struct matrix_lru_entry
+{
+    int lfsr_poly_size;
+    int num_data_bits;
+    std::vector<gf2_word> lfsr_poly;
+    gf2_matrix matrix;
+
+    ~matrix_lru_entry() { gf2_matrix_free(&matrix); }
+};
+
+struct matrix_lru
+{
+    size_t max_bytes;
+    size_t bytes;
+    std::list<std::shared_ptr<matrix_lru_entry> > entries; // most recent first
+    std::mutex lock;
+    std::atomic<long long> hits;
+    std::atomic<long long> misses;
+};
+
+void matrix_lru_init(matrix_lru *c, size_t max_bytes);
+
+// copy of the cached matrix of this polynomial and data width into a newly
+// allocated matrix, false on a miss or failed allocation
+bool matrix_lru_get(matrix_lru *c,
+                    int lfsr_poly_size,
+                    int num_data_bits,
+                    const gf2_word *lfsr_poly,
+                    gf2_matrix *matrix);
+
+// store a copy of the matrix, dropping old entries to make room. false on
+// failed allocation
+bool matrix_lru_put(matrix_lru *c,
+                    int lfsr_poly_size,
+                    int num_data_bits,
+                    const gf2_word *lfsr_poly,
+                    const gf2_matrix *matrix);
+
+// number of entries and their bytes
+void matrix_lru_size(matrix_lru *c, int *entries, size_t *bytes);
+
+#endif // MATRIX_LRU_H
@@ -0,0 +1,79 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// number of worker threads for '-j 0'
+static inline int parallel_default_threads()
+{
+    unsigned int n = std::thread::hardware_concurrency();
+    return n ? (int)n : 1;
+}
+
+//
+// run fn(item, thread) for item = 0..num_items-1 on num_threads threads
+//
+// items are handed out one at a time from a shared counter, so a thread that
+// finishes early keeps pulling work instead of idling behind a static split.
+// 'thread' is 0..num_threads-1 and can be used to index per-thread scratch.
+//
+template <typename F>
+void parallel_for(int num_items, int num_threads, F fn)
+{
+    if (num_threads > num_items)
+        num_threads = num_items;
+
+    if (num_threads <= 1)
+    {
+        for (int i = 0; i < num_items; i++)
+            fn(i, 0);
+        return;
+    }
+
+    std::atomic<int> next_item(0);
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < num_threads; t++)
+    {
+        workers.emplace_back([&, t]()
+                             {
+                                 for (int i = next_item++; i < num_items; i = next_item++)
+                                     fn(i, t);
+                             });
+    }
+
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+}
+
+#endif // PARALLEL_H
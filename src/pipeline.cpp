@@ -0,0 +1,139 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "cost.h"
+#include "pipeline.h"
+
+void plan_pipeline(const gf2_matrix *eq, int N, int M, int stages, crc_pipeline *p)
+{
+    int max_terms = 0;
+
+    for (int n2 = 0; n2 < eq->rows; n2++)
+    {
+        const gf2_word *row = gf2_row(eq, n2);
+        int terms = 0;
+
+        for (int t = gf2_next_set(row, eq->words, N); t >= 0 && t < N + M; t = gf2_next_set(row, eq->words, t + 1))
+            terms++;
+
+        if (max_terms < terms)
+            max_terms = terms;
+    }
+
+    // smallest fan-in that covers the widest sum in 'stages' levels
+    int fan_in = 1;
+
+    for (;;)
+    {
+        long long reach = 1;
+
+        for (int s = 0; s < stages && reach < max_terms; s++)
+            reach *= fan_in;
+
+        if (reach >= max_terms)
+            break;
+
+        fan_in++;
+    }
+
+    p->stages = stages;
+    p->fan_in = fan_in;
+    p->nodes.assign(stages, std::vector<std::vector<int>>());
+
+    // every row is its own tree, cut into balanced groups stage by stage
+    for (int n2 = 0; n2 < eq->rows; n2++)
+    {
+        const gf2_word *row = gf2_row(eq, n2);
+        std::vector<int> items;
+
+        for (int t = gf2_next_set(row, eq->words, N); t >= 0 && t < N + M; t = gf2_next_set(row, eq->words, t + 1))
+            items.push_back(t - N);
+
+        for (int s = 0; s < stages; s++)
+        {
+            int groups = s == stages - 1 ? 1 : ((int)items.size() + fan_in - 1) / fan_in;
+
+            if (groups < 1)
+                groups = 1;
+
+            std::vector<int> next;
+
+            for (int g = 0; g < groups; g++)
+            {
+                // spread the items evenly over the groups
+                size_t from = items.size() * g / groups;
+                size_t to = items.size() * (g + 1) / groups;
+
+                next.push_back((int)p->nodes[s].size());
+                p->nodes[s].push_back(std::vector<int>(items.begin() + from, items.begin() + to));
+            }
+
+            items = next;
+        }
+    }
+}
+
+void report_pipeline(FILE *fp, const char *name, const gf2_matrix *eq, int N, const crc_pipeline *p)
+{
+    int max_flat = 0;
+    int max_loop = 0;
+
+    for (int n2 = 0; n2 < eq->rows; n2++)
+    {
+        const gf2_word *row = gf2_row(eq, n2);
+        int terms = gf2_vec_popcount(row, eq->words);
+        int state_terms = 0;
+
+        for (int t = gf2_next_set(row, eq->words, 0); t >= 0 && t < N; t = gf2_next_set(row, eq->words, t + 1))
+            state_terms++;
+
+        if (max_flat < terms)
+            max_flat = terms;
+
+        // plus the last pipeline register, if the row has data terms
+        if (max_loop < state_terms + (terms > state_terms))
+            max_loop = state_terms + (terms > state_terms);
+    }
+
+    for (int s = 0; s < p->stages; s++)
+    {
+        int max_in = 0;
+
+        for (size_t i = 0; i < p->nodes[s].size(); i++)
+        {
+            if (max_in < (int)p->nodes[s][i].size())
+                max_in = (int)p->nodes[s][i].size();
+        }
+
+        fprintf(fp, "%s: pipeline stage %d: %d registers, max %d inputs, %d xor2 levels\n",
+                name, s + 1, (int)p->nodes[s].size(), max_in, xor2_levels(max_in));
+    }
+
+    fprintf(fp, "%s: feedback: max %d inputs, %d xor2 levels (flat %d inputs, %d levels)\n",
+            name, max_loop, xor2_levels(max_loop), max_flat, xor2_levels(max_flat));
+}
@@ -0,0 +1,62 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "gf2.h"
+
+//
+// register stages for the data half of the CRC equations
+//
+// lfsr_c[n2] = (lfsr_q terms) ^ (data terms). the data terms do not depend on
+// the state, so their XOR can be computed ahead in a tree of K register stages
+// and only the short lfsr_q part stays in the feedback loop.
+//
+// nodes[s][i] lists the inputs of register i of stage s+1: data bit indices
+// for the first stage, registers of stage s for the others. the last stage has
+// one register per lfsr_c bit, with no inputs if that bit has no data terms.
+//
+struct crc_pipeline
+{
+    int stages;
+    int fan_in; // max inputs of one register
+    std::vector<std::vector<std::vector<int>>> nodes;
+};
+
+// split the data terms of the rows of eq (N state columns, then M data columns)
+void plan_pipeline(const gf2_matrix *eq, int N, int M, int stages, crc_pipeline *p);
+
+// registers, inputs and XOR2 levels of each stage and of the feedback path
+void report_pipeline(FILE *fp, const char *name, const gf2_matrix *eq, int N, const crc_pipeline *p);
+
+#endif // PIPELINE_H
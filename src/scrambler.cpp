@@ -0,0 +1,301 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "bitslice.h"
+#include "crc-gen.h"
+#include "parallel.h"
+#include "scrambler.h"
+
+//
+// the matrix columns are independent unit inputs, so SLICE_VECTORS of them
+// run through one bit-sliced LFSR: lane bit t of every signal belongs to
+// column block*SLICE_VECTORS+t, and each signal's lane after the beat is a
+// block of SLICE_WORDS words of its row.
+//
+void build_scrambler_matrix(int lfsr_poly_size,
+                            const gf2_word *lfsr_poly,
+                            int num_data_bits,
+                            scrambler_type type,
+                            bool descramble,
+                            gf2_matrix *matrix,
+                            int num_threads)
+{
+    int N = lfsr_poly_size;
+    int M = num_data_bits;
+    int blocks = (N + M + SLICE_VECTORS - 1) / SLICE_VECTORS;
+
+    parallel_for(blocks, num_threads, [&](int block, int)
+                 {
+                     sliced_lfsr r;
+                     std::vector<slice_lane> data(M);
+                     slice_lane zero = slice_lane();
+
+                     sliced_lfsr_init(&r, N, lfsr_poly);
+
+                     for (int t = 0; t < SLICE_VECTORS && block * SLICE_VECTORS + t < N + M; t++)
+                     {
+                         int col = block * SLICE_VECTORS + t;
+                         slice_lane *v = col < N ? sliced_lfsr_bit(&r, col) : &data[col - N];
+
+                         v->w[t / GF2_WORD_BITS] |= (gf2_word)1 << (t % GF2_WORD_BITS);
+                     }
+
+                     // rows of the signals, the words of this block only
+                     auto store = [&](int row, const slice_lane *v)
+                     {
+                         for (int l = 0; l < SLICE_WORDS && block * SLICE_WORDS + l < matrix->words; l++)
+                             gf2_row(matrix, row)[block * SLICE_WORDS + l] = v->w[l];
+                     };
+
+                     for (int j = 0; j < M; j++)
+                     {
+                         const slice_lane *d = &data[M - 1 - j];
+                         slice_lane bit = *sliced_lfsr_bit(&r, N - 1);
+
+                         lane_xor(&bit, d);
+
+                         if (type == SCRAMBLER_ADDITIVE)
+                             sliced_lfsr_shift(&r, &zero);
+                         else
+                             sliced_lfsr_shift(&r, descramble ? &bit : d);
+
+                         store(N + M - 1 - j, &bit);
+                     }
+
+                     for (int n = 0; n < N; n++)
+                         store(n, sliced_lfsr_bit(&r, n));
+                 });
+
+} // build_scrambler_matrix
+
+static const char *scrambler_name(scrambler_type type, bool descramble)
+{
+    if (type == SCRAMBLER_ADDITIVE)
+        return descramble ? "additive descrambler" : "additive scrambler";
+    else
+        return descramble ? "self-synchronous descrambler" : "self-synchronous scrambler";
+}
+
+// "1+x^a+...+x^N", the feedback of the LFSR
+static void emit_scrambler_poly(emit_buf *out, int lfsr_poly_size, const gf2_word *lfsr_poly)
+{
+    EMIT_LIT(out, "1");
+
+    for (int l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), 1); l >= 0; l = gf2_next_set(lfsr_poly, GF2_WORDS(lfsr_poly_size), l + 1))
+        emit_fmt(out, "+x^%d", l);
+
+    emit_fmt(out, "+x^%d", lfsr_poly_size);
+}
+
+//
+// the state rows are printed as the lfsr_c equations of a CRC core, the
+// output rows by the same printer from a view of rows N..N+M-1
+//
+static void scrambler_equations(crc_equations *lfsr_eq,
+                                gf2_matrix *data_rows,
+                                int lfsr_poly_size,
+                                int num_data_bits,
+                                const gf2_word *lfsr_poly,
+                                const gf2_matrix *matrix)
+{
+    lfsr_eq->lfsr_poly_size = lfsr_poly_size;
+    lfsr_eq->num_data_bits = num_data_bits;
+    lfsr_eq->lfsr_poly = lfsr_poly;
+    lfsr_eq->streaming = false;
+    lfsr_eq->first_row = 0;
+    lfsr_eq->rows = *matrix;
+    lfsr_eq->num_shared = 0;
+    lfsr_eq->shared_pairs = NULL;
+    lfsr_eq->pipeline = NULL;
+    lfsr_eq->num_keep_sets = 0;
+    lfsr_eq->keep_rows = NULL;
+    lfsr_eq->lanes = NULL;
+    lfsr_eq->fold = 1;
+    lfsr_eq->lut6 = NULL;
+
+    *data_rows = *matrix;
+    data_rows->rows = num_data_bits;
+    data_rows->bits = (gf2_word *)gf2_row(matrix, lfsr_poly_size);
+}
+
+void print_verilog_scrambler(emit_buf *out,
+                             int lfsr_poly_size,
+                             int num_data_bits,
+                             const gf2_word *lfsr_poly,
+                             scrambler_type type,
+                             bool descramble,
+                             const gf2_matrix *matrix)
+{
+    const char *module = descramble ? "descrambler" : "scrambler";
+    crc_equations lfsr_eq;
+    gf2_matrix data_rows;
+
+    scrambler_equations(&lfsr_eq, &data_rows, lfsr_poly_size, num_data_bits, lfsr_poly, matrix);
+
+    EMIT_LIT(out, "\n//-----------------------------------------------------------------------------\n");
+    emit_fmt(out, "// %s for\n", scrambler_name(type, descramble));
+    emit_fmt(out, "//    data[%d:0]\n", num_data_bits - 1);
+    emit_fmt(out, "//    lfsr[%d:0]=", lfsr_poly_size - 1);
+    emit_scrambler_poly(out, lfsr_poly_size, lfsr_poly);
+    EMIT_LIT(out, ";\n");
+    EMIT_LIT(out, "// data_in[DATA_WIDTH-1] is the first bit in time, data_in[0] with LSB_FIRST.\n");
+    EMIT_LIT(out, "// data_out is combinational, lfsr_q advances on data_en.\n");
+    EMIT_LIT(out, "//-----------------------------------------------------------------------------\n\n");
+
+    emit_fmt(out, "module %s #(\n", module);
+    emit_fmt(out, "    parameter DATA_WIDTH = %d,\n", num_data_bits);
+    emit_fmt(out, "    parameter LFSR_WIDTH = %d,\n", lfsr_poly_size);
+    emit_fmt(out, "    parameter INIT       = {%d{1'b1}},\n", lfsr_poly_size);
+    EMIT_LIT(out, "    parameter LSB_FIRST  = 1'b0\n");
+    EMIT_LIT(out, ") (\n");
+    EMIT_LIT(out, "    input  wire [(DATA_WIDTH-1):0] data_in,\n");
+    EMIT_LIT(out, "    input  wire                    data_en,\n");
+    EMIT_LIT(out, "    output wire [(DATA_WIDTH-1):0] data_out,\n");
+    EMIT_LIT(out, "    input  wire                    rst,\n");
+    EMIT_LIT(out, "    input  wire                    clk\n");
+    EMIT_LIT(out, ");\n\n");
+
+    EMIT_LIT(out, "    genvar ii;\n");
+    EMIT_LIT(out, "    wire [(DATA_WIDTH-1):0] data_in_inv;\n");
+    EMIT_LIT(out, "    wire [(DATA_WIDTH-1):0] data_in_inv_res;\n");
+    EMIT_LIT(out, "    wire [(DATA_WIDTH-1):0] data_c_inv;\n");
+    EMIT_LIT(out, "    reg  [(DATA_WIDTH-1):0] data_c;\n");
+    EMIT_LIT(out, "    reg  [(LFSR_WIDTH-1):0] lfsr_q;\n");
+    EMIT_LIT(out, "    reg  [(LFSR_WIDTH-1):0] lfsr_c;\n\n");
+
+    EMIT_LIT(out, "    generate\n");
+    EMIT_LIT(out, "        for (ii = 0; ii < DATA_WIDTH; ii = ii + 1) begin\n");
+    EMIT_LIT(out, "            assign data_in_inv[ii] = data_in[DATA_WIDTH-ii-1];\n");
+    EMIT_LIT(out, "            assign data_c_inv[ii]  = data_c[DATA_WIDTH-ii-1];\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "    endgenerate\n\n");
+
+    EMIT_LIT(out, "    // bit order\n");
+    EMIT_LIT(out, "    assign data_in_inv_res = (LSB_FIRST == 1'b1) ? (data_in_inv) : data_in;\n");
+    EMIT_LIT(out, "    assign data_out        = (LSB_FIRST == 1'b1) ? (data_c_inv) : data_c;\n\n");
+
+    EMIT_LIT(out, "    always @(*) begin");
+    emit_equations(out, &lfsr_eq, NULL, 0, "lfsr_c", false);
+    EMIT_LIT(out, "\n    end // always\n\n");
+
+    EMIT_LIT(out, "    always @(*) begin");
+    emit_equations(out, &lfsr_eq, &data_rows, 0, "data_c", false);
+    EMIT_LIT(out, "\n    end // always\n\n");
+
+    EMIT_LIT(out, "    always @(posedge clk, posedge rst) begin\n");
+    EMIT_LIT(out, "        if (rst) begin\n");
+    EMIT_LIT(out, "            lfsr_q <= INIT;\n");
+    EMIT_LIT(out, "        end else begin\n");
+    EMIT_LIT(out, "            lfsr_q <= data_en ? lfsr_c : lfsr_q;\n");
+    EMIT_LIT(out, "        end\n");
+    EMIT_LIT(out, "    end // always\n");
+    emit_fmt(out, "endmodule // %s\n\n", module);
+
+} // print_verilog_scrambler
+
+void print_vhdl_scrambler(emit_buf *out,
+                          int lfsr_poly_size,
+                          int num_data_bits,
+                          const gf2_word *lfsr_poly,
+                          scrambler_type type,
+                          bool descramble,
+                          const gf2_matrix *matrix)
+{
+    const char *module = descramble ? "descrambler" : "scrambler";
+    crc_equations lfsr_eq;
+    gf2_matrix data_rows;
+
+    scrambler_equations(&lfsr_eq, &data_rows, lfsr_poly_size, num_data_bits, lfsr_poly, matrix);
+
+    EMIT_LIT(out, "\n-------------------------------------------------------------------------------\n");
+    emit_fmt(out, "-- %s for\n", scrambler_name(type, descramble));
+    emit_fmt(out, "--    data(%d downto 0)\n", num_data_bits - 1);
+    emit_fmt(out, "--    lfsr(%d downto 0)=", lfsr_poly_size - 1);
+    emit_scrambler_poly(out, lfsr_poly_size, lfsr_poly);
+    EMIT_LIT(out, ";\n");
+    EMIT_LIT(out, "-- data_in(DATA_WIDTH-1) is the first bit in time, data_in(0) with LSB_FIRST.\n");
+    EMIT_LIT(out, "-- data_out is combinational, lfsr_q advances on data_en.\n");
+    EMIT_LIT(out, "-------------------------------------------------------------------------------\n");
+
+    EMIT_LIT(out, "library ieee;\n");
+    EMIT_LIT(out, "use ieee.std_logic_1164.all;\n\n");
+
+    emit_fmt(out, "entity %s is\n", module);
+    EMIT_LIT(out, "    generic (\n");
+    emit_fmt(out, "        DATA_WIDTH : integer := %d;\n", num_data_bits);
+    emit_fmt(out, "        LFSR_WIDTH : integer := %d;\n", lfsr_poly_size);
+    emit_fmt(out, "        INIT       : std_logic_vector(%d downto 0) := (others => '1');\n", lfsr_poly_size - 1);
+    EMIT_LIT(out, "        LSB_FIRST  : std_logic := '0'\n");
+    EMIT_LIT(out, "    );\n");
+    EMIT_LIT(out, "    port (\n");
+    EMIT_LIT(out, "        data_in  : in  std_logic_vector((DATA_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "        data_en  : in  std_logic;\n");
+    EMIT_LIT(out, "        data_out : out std_logic_vector((DATA_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "        rst      : in  std_logic;\n");
+    EMIT_LIT(out, "        clk      : in  std_logic\n");
+    EMIT_LIT(out, "    );\n");
+    emit_fmt(out, "end entity %s;\n\n", module);
+
+    emit_fmt(out, "architecture imp_%s of %s is\n", module, module);
+    EMIT_LIT(out, "    signal data_in_inv      : std_logic_vector((DATA_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal data_in_inv_res  : std_logic_vector((DATA_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal data_c_inv       : std_logic_vector((DATA_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal data_c           : std_logic_vector((DATA_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal lfsr_q           : std_logic_vector((LFSR_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "    signal lfsr_c           : std_logic_vector((LFSR_WIDTH-1) downto 0);\n");
+    EMIT_LIT(out, "begin\n\n");
+
+    EMIT_LIT(out, "    -- bit order\n");
+    EMIT_LIT(out, "    gen_inv: for ii in 0 to DATA_WIDTH-1 generate\n");
+    EMIT_LIT(out, "        data_in_inv(ii) <= data_in(DATA_WIDTH-ii-1);\n");
+    EMIT_LIT(out, "        data_c_inv(ii)  <= data_c(DATA_WIDTH-ii-1);\n");
+    EMIT_LIT(out, "    end generate gen_inv;\n\n");
+    EMIT_LIT(out, "    data_in_inv_res <= data_in_inv when LSB_FIRST = '1' else data_in;\n");
+    EMIT_LIT(out, "    data_out        <= data_c_inv when LSB_FIRST = '1' else data_c;\n");
+
+    emit_equations(out, &lfsr_eq, NULL, 0, "lfsr_c", true);
+    EMIT_LIT(out, "\n");
+    emit_equations(out, &lfsr_eq, &data_rows, 0, "data_c", true);
+    EMIT_LIT(out, "\n\n");
+
+    EMIT_LIT(out, "    process (clk, rst) begin\n");
+    EMIT_LIT(out, "        if rst = '1' then\n");
+    EMIT_LIT(out, "            lfsr_q <= INIT;\n");
+    EMIT_LIT(out, "        elsif rising_edge(clk) then\n");
+    EMIT_LIT(out, "            if data_en = '1' then\n");
+    EMIT_LIT(out, "                lfsr_q <= lfsr_c;\n");
+    EMIT_LIT(out, "            end if;\n");
+    EMIT_LIT(out, "        end if;\n");
+    EMIT_LIT(out, "    end process;\n\n");
+    emit_fmt(out, "end architecture imp_%s;\n", module);
+
+} // print_vhdl_scrambler
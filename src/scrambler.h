@@ -0,0 +1,90 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SCRAMBLER_H
+#define SCRAMBLER_H
+
+#include "emit.h"
+#include "gf2.h"
+
+//
+// parallel scramblers on the LFSR of the CRC core
+//
+// every kind runs the LFSR of lfsr_serial_shift_crc, f = poly|1, and takes
+// its output from the top bit q[N-1] before the shift:
+//
+//   additive        out = d ^ q[N-1], the LFSR shifts zeros (PCIe, 802.3
+//                   side-stream)
+//   self-sync       out = d ^ q[N-1], the feedback of the CRC of d, so the
+//                   scrambler is the CRC LFSR fed with the data (64b/66b)
+//   self-sync descr out = s ^ q[N-1], the LFSR is fed with the descrambled
+//                   out, which makes its state the CRC of the data again
+//
+// an additive descrambler is the scrambler itself. the self-synchronous
+// scrambler with f computes out[n] = d[n] ^ out[n-(N-i)] over the set bits
+// i of f, so a scrambler given by its delays, 1 + x^a + x^N, has the poly
+// x^N + x^(N-a) + 1: 64b/66b is poly_width 58, poly_string 000000000080001.
+//
+enum scrambler_type
+{
+    SCRAMBLER_NONE,
+    SCRAMBLER_ADDITIVE,
+    SCRAMBLER_SELF_SYNC,
+};
+
+//
+// the unrolled M bit beat as a (N+M)x(N+M) matrix with the columns of the
+// CRC equations (lfsr_q, then data_in_inv_res): rows 0..N-1 are the next
+// state lfsr_c, rows N..N+M-1 the output bits data_c[m]. data_in_inv_res[M-1]
+// is the first bit in time, as for the CRC.
+//
+void build_scrambler_matrix(int lfsr_poly_size,
+                            const gf2_word *lfsr_poly,
+                            int num_data_bits,
+                            scrambler_type type,
+                            bool descramble,
+                            gf2_matrix *matrix,
+                            int num_threads);
+
+void print_verilog_scrambler(emit_buf *out,
+                             int lfsr_poly_size,
+                             int num_data_bits,
+                             const gf2_word *lfsr_poly,
+                             scrambler_type type,
+                             bool descramble,
+                             const gf2_matrix *matrix);
+
+void print_vhdl_scrambler(emit_buf *out,
+                          int lfsr_poly_size,
+                          int num_data_bits,
+                          const gf2_word *lfsr_poly,
+                          scrambler_type type,
+                          bool descramble,
+                          const gf2_matrix *matrix);
+
+#endif // SCRAMBLER_H
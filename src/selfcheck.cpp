@@ -0,0 +1,342 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "bitslice.h"
+#include "crc-gen.h"
+#include "parallel.h"
+#include "selfcheck.h"
+
+// first differing bit of a batch
+struct selfcheck_miss
+{
+    int vector; // within the batch
+    int beat;
+    int n2;
+};
+
+//
+// the equations as term lists, and the scratch of one thread
+//
+struct selfcheck_ctx
+{
+    int N;
+    int W;
+    const gf2_word *lfsr_poly;
+    const selfcheck_equations *eq;
+    int beats;
+
+    std::vector<std::vector<int>> terms; // per lfsr_c bit, without the pipelined data terms
+    std::vector<std::vector<int>> lane_terms; // per lane_crc bit, the data bits of lane 0
+};
+
+struct selfcheck_scratch
+{
+    std::vector<slice_lane> in; // state, data, shared terms or lane CRCs
+    std::vector<slice_lane> out;
+    std::vector<std::vector<slice_lane>> stage;
+    sliced_lfsr lfsr;
+};
+
+//
+// the serial LFSR shifted on vectors 0..3 with lfsr_serial_shift_crc, against
+// the bit-sliced copy
+//
+static bool check_serial_model(const selfcheck_ctx *c, const slice_lane *state, const slice_lane *data, sliced_lfsr *lfsr)
+{
+    int N = c->N;
+    int W = c->W;
+    std::vector<gf2_word> cur(GF2_WORDS(N)), next(GF2_WORDS(N)), bits(GF2_WORDS(W));
+
+    for (int t = 0; t < 4; t++)
+    {
+        gf2_vec_zero(&cur[0], GF2_WORDS(N));
+        gf2_vec_zero(&bits[0], GF2_WORDS(W));
+
+        for (int n = 0; n < N; n++)
+        {
+            if (lane_bit(&state[n], t))
+                gf2_set(&cur[0], n);
+        }
+
+        // data_in_inv_res[W-1] is shifted in first
+        for (int m = 0; m < W; m++)
+        {
+            if (lane_bit(&data[m], t))
+                gf2_set(&bits[0], W - 1 - m);
+        }
+
+        lfsr_serial_shift_crc(W, N, c->lfsr_poly, &cur[0], &next[0], W, &bits[0]);
+
+        for (int n = 0; n < N; n++)
+        {
+            if (gf2_get(&next[0], n) != (int)lane_bit(sliced_lfsr_bit(lfsr, n), t))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//
+// SLICE_VECTORS vectors of c->beats beats each, returns false on the first
+// mismatch. batch 0 also checks the bit-sliced serial model itself.
+//
+static bool selfcheck_batch(const selfcheck_ctx *c, selfcheck_scratch *s, long long batch, selfcheck_miss *miss)
+{
+    int N = c->N;
+    int W = c->W;
+    const selfcheck_equations *eq = c->eq;
+    uint64_t seed = 0x243f6a8885a308d3ull ^ ((uint64_t)batch << 20);
+
+    slice_lane *state = &s->in[0];
+    slice_lane *data = &s->in[N];
+    slice_lane *shared = &s->in[N + W];
+    slice_lane *lane_crc = &s->in[N + W];
+
+    sliced_lfsr_init(&s->lfsr, N, c->lfsr_poly);
+
+    for (int n = 0; n < N; n++)
+    {
+        lane_random(&state[n], &seed);
+        *sliced_lfsr_bit(&s->lfsr, n) = state[n];
+    }
+
+    for (int beat = 0; beat < c->beats; beat++)
+    {
+        for (int m = 0; m < W; m++)
+            lane_random(&data[m], &seed);
+
+        // the equations
+        for (int k = 0; k < eq->num_shared; k++)
+        {
+            shared[k] = s->in[eq->shared_pairs[2 * k]];
+            lane_xor(&shared[k], &s->in[eq->shared_pairs[2 * k + 1]]);
+        }
+
+        // the registered lane CRCs of this beat, the combine stage reads
+        // them on the next clock with the state of then
+        for (int l = 0; eq->lanes && l < eq->lanes->lanes; l++)
+        {
+            const slice_lane *lane = &data[l * eq->lanes->lane_width];
+
+            for (int i = 0; i < N; i++)
+            {
+                const std::vector<int> &t = c->lane_terms[i];
+                slice_lane v = slice_lane();
+
+                for (size_t j = 0; j < t.size(); j++)
+                    lane_xor(&v, &lane[t[j]]);
+
+                lane_crc[l * N + i] = v;
+            }
+        }
+
+        const crc_pipeline *pipe = eq->pipeline;
+
+        for (int st = 0; pipe && st < pipe->stages; st++)
+        {
+            const std::vector<std::vector<int>> &nodes = pipe->nodes[st];
+
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                slice_lane *v = &s->stage[st][i];
+
+                *v = slice_lane();
+
+                for (size_t j = 0; j < nodes[i].size(); j++)
+                    lane_xor(v, st ? &s->stage[st - 1][nodes[i][j]] : &data[nodes[i][j]]);
+            }
+        }
+
+        for (int n2 = 0; n2 < N; n2++)
+        {
+            const std::vector<int> &t = c->terms[n2];
+            slice_lane v = pipe ? s->stage[pipe->stages - 1][n2] : slice_lane();
+
+            for (size_t j = 0; j < t.size(); j++)
+                lane_xor(&v, &s->in[t[j]]);
+
+            s->out[n2] = v;
+        }
+
+        // the serial LFSR, data_in_inv_res[W-1] first
+        for (int m = W - 1; m >= 0; m--)
+            sliced_lfsr_shift(&s->lfsr, &data[m]);
+
+        if (batch == 0 && beat == 0 && !check_serial_model(c, state, data, &s->lfsr))
+        {
+            miss->vector = -1;
+            return false;
+        }
+
+        for (int n2 = 0; n2 < N; n2++)
+        {
+            const slice_lane *ref = sliced_lfsr_bit(&s->lfsr, n2);
+
+            for (int l = 0; l < SLICE_WORDS; l++)
+            {
+                gf2_word diff = s->out[n2].w[l] ^ ref->w[l];
+
+                if (diff)
+                {
+                    miss->vector = l * GF2_WORD_BITS + gf2_ctz(diff);
+                    miss->beat = beat;
+                    miss->n2 = n2;
+                    return false;
+                }
+            }
+        }
+
+        // next beat from the new state
+        for (int n = 0; n < N; n++)
+            state[n] = s->out[n];
+    }
+
+    return true;
+
+} // selfcheck_batch
+
+long long selfcheck_max_vectors(int beats)
+{
+    return 0x7fffffffLL * SLICE_VECTORS * beats;
+}
+
+bool selfcheck_crc(FILE *fp,
+                   const char *name,
+                   int lfsr_poly_size,
+                   const gf2_word *lfsr_poly,
+                   const selfcheck_equations *eq,
+                   long long vectors,
+                   int beats,
+                   int num_threads)
+{
+    selfcheck_ctx c;
+    int N = lfsr_poly_size;
+    int W = eq->data_width;
+
+    c.N = N;
+    c.W = W;
+    c.lfsr_poly = lfsr_poly;
+    c.eq = eq;
+    c.beats = beats;
+    c.terms.resize(N);
+
+    for (int n2 = 0; n2 < N; n2++)
+    {
+        const gf2_word *row = gf2_row(eq->rows, n2);
+
+        for (int t = gf2_next_set(row, eq->rows->words, 0); t >= 0; t = gf2_next_set(row, eq->rows->words, t + 1))
+        {
+            // pipelined data terms come from the last stage instead
+            if (!eq->pipeline || t < N || t >= N + W)
+                c.terms[n2].push_back(t);
+        }
+    }
+
+    for (int i = 0; eq->lanes && i < N; i++)
+    {
+        const gf2_word *row = gf2_row(&eq->lanes->lane_rows, i);
+
+        c.lane_terms.push_back(std::vector<int>());
+
+        for (int j = gf2_next_set(row, eq->lanes->lane_rows.words, N); j >= 0; j = gf2_next_set(row, eq->lanes->lane_rows.words, j + 1))
+            c.lane_terms[i].push_back(j - N);
+    }
+
+    if (num_threads < 1)
+        num_threads = 1;
+
+    if (vectors > selfcheck_max_vectors(beats))
+    {
+        fprintf(fp, "%s: selfcheck: %lld vectors, at most %lld can be checked\n", name, vectors, selfcheck_max_vectors(beats));
+        return false;
+    }
+
+    // every beat of a sequence counts as one vector
+    long long batches = (vectors + (long long)SLICE_VECTORS * beats - 1) / ((long long)SLICE_VECTORS * beats);
+    std::vector<selfcheck_scratch> scratch(num_threads);
+
+    for (int t = 0; t < num_threads; t++)
+    {
+        scratch[t].in.resize(N + W + eq->num_shared + (eq->lanes ? eq->lanes->lanes * N : 0));
+        scratch[t].out.resize(N);
+
+        for (int st = 0; eq->pipeline && st < eq->pipeline->stages; st++)
+            scratch[t].stage.push_back(std::vector<slice_lane>(eq->pipeline->nodes[st].size()));
+    }
+
+    // the lowest failing batch wins, so the report does not depend on -j
+    std::atomic<long long> first_bad(batches);
+    std::atomic<long long> checked(0);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+    parallel_for((int)batches, num_threads, [&](int batch, int thread)
+                 {
+                     selfcheck_miss miss;
+
+                     if (batch > first_bad)
+                         return;
+
+                     checked++;
+
+                     if (selfcheck_batch(&c, &scratch[thread], batch, &miss))
+                         return;
+
+                     long long cur = first_bad;
+
+                     while (batch < cur && !first_bad.compare_exchange_weak(cur, batch))
+                         ;
+                 });
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (first_bad < batches)
+    {
+        selfcheck_miss miss;
+
+        selfcheck_batch(&c, &scratch[0], first_bad, &miss);
+
+        if (miss.vector < 0)
+            fprintf(fp, "%s: selfcheck: bit-sliced serial LFSR disagrees with lfsr_serial_shift_crc\n", name);
+        else
+            fprintf(fp, "%s: selfcheck failed, %d bit data: lfsr_c[%d] differs from the serial LFSR in sequence %lld beat %d\n",
+                    name, W, miss.n2, (long long)first_bad * SLICE_VECTORS + miss.vector, miss.beat);
+
+        return false;
+    }
+
+    fprintf(fp, "%s: selfcheck %d bit data: %lld vectors in sequences of %d beats ok (%.2f s)\n",
+            name, W, (long long)checked * SLICE_VECTORS * beats, beats, elapsed);
+
+    return true;
+
+} // selfcheck_crc
@@ -0,0 +1,73 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SELFCHECK_H
+#define SELFCHECK_H
+
+#include <stdio.h>
+
+#include "gf2.h"
+#include "lanes.h"
+#include "pipeline.h"
+
+//
+// bit-sliced check of the CRC equations against the serial LFSR
+//
+// the input signals are bit-sliced lanes (see bitslice.h), so one XOR
+// evaluates a term for SLICE_VECTORS test vectors. the equations are
+// evaluated the way the printers emit them (shared XOR terms, pipeline trees,
+// lane CRCs)
+// and compared with a bit-sliced copy of lfsr_serial_shift_crc, which itself
+// is checked on a few vectors against the real thing. the vectors come in
+// sequences of 'beats' beats from a random state, each beat continuing from
+// the state the equations left.
+//
+struct selfcheck_equations
+{
+    const gf2_matrix *rows; // N state columns, data_width data columns, shared
+    int data_width;
+    int num_shared;
+    const int *shared_pairs;
+    const crc_pipeline *pipeline; // NULL for a single cycle core
+    const crc_lanes *lanes; // rows are the combine equations, NULL for flat
+};
+
+// returns false and prints the first differing bit to fp on a mismatch
+bool selfcheck_crc(FILE *fp,
+                   const char *name,
+                   int lfsr_poly_size,
+                   const gf2_word *lfsr_poly,
+                   const selfcheck_equations *eq,
+                   long long vectors,
+                   int beats,
+                   int num_threads);
+
+// the most vectors selfcheck_crc() takes, its batches are counted in an int
+long long selfcheck_max_vectors(int beats);
+
+#endif // SELFCHECK_H
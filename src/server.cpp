@@ -0,0 +1,547 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "server.h"
+
+#if defined(_WIN32)
+
+int run_server(const char *socket_path, int num_threads, matrix_lru *lru, server_handler handler, void *ctx)
+{
+    (void)socket_path;
+    (void)num_threads;
+    (void)lru;
+    (void)handler;
+    (void)ctx;
+
+    fprintf(stderr, "\n\terror: --serve needs Unix domain sockets, not available on this platform\n");
+    return 1;
+}
+
+int run_client(const char *socket_path, int argc, char **argv, const char *out_path)
+{
+    (void)socket_path;
+    (void)argc;
+    (void)argv;
+    (void)out_path;
+
+    fprintf(stderr, "\n\terror: --client needs Unix domain sockets, not available on this platform\n");
+    return 1;
+}
+
+#else
+
+#include <errno.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "emit.h"
+
+// longest request accepted, the arguments of one command line
+#define SERVER_REQUEST_MAX (1 << 16)
+
+// a request not complete by then is answered "error timeout" and dropped,
+// so a stalled client can not hold a worker
+#define SERVER_READ_TIMEOUT_MS 10000
+
+struct server_state
+{
+    const char *socket_path;
+    matrix_lru *lru;
+    server_handler handler;
+    void *ctx;
+
+    // accepted connections waiting for a worker
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<int> queue;
+    bool stopping;
+
+    std::chrono::steady_clock::time_point start;
+    std::atomic<long long> requests;
+    std::atomic<long long> errors;
+    std::atomic<long long> busy_us;
+};
+
+static bool write_all(int fd, const char *p, size_t n)
+{
+    while (n)
+    {
+        ssize_t k = write(fd, p, n);
+
+        if (k < 0 && errno == EINTR)
+            continue;
+
+        if (k <= 0)
+            return false;
+
+        p += k;
+        n -= (size_t)k;
+    }
+
+    return true;
+}
+
+static bool unix_address(const char *path, sockaddr_un *addr)
+{
+    if (strlen(path) >= sizeof(addr->sun_path))
+        return false;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    strcpy(addr->sun_path, path);
+
+    return true;
+}
+
+// connected socket, -1 if nobody listens on path
+static int connect_unix(const char *path)
+{
+    sockaddr_un addr;
+    int fd;
+
+    if (!unix_address(path, &addr) || (fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+        return -1;
+
+    if (connect(fd, (const sockaddr *)&addr, sizeof(addr)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void reply_ok(int fd, const char *data, size_t size)
+{
+    char head[32];
+
+    snprintf(head, sizeof(head), "ok %llu\n", (unsigned long long)size);
+
+    if (write_all(fd, head, strlen(head)))
+        write_all(fd, data, size);
+}
+
+static void reply_error(int fd, const std::string &message)
+{
+    std::string line = "error " + message + "\n";
+
+    write_all(fd, line.data(), line.size());
+}
+
+static std::string server_stats(server_state *s)
+{
+    double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - s->start).count();
+    long long requests = s->requests;
+    long long hits = s->lru->hits;
+    long long misses = s->lru->misses;
+    int entries;
+    size_t bytes;
+    char text[512];
+
+    matrix_lru_size(s->lru, &entries, &bytes);
+
+    snprintf(text, sizeof(text),
+             "requests %lld, errors %lld, uptime %.1f s, %.2f requests/s, %.3f ms per request\n"
+             "matrix cache: %lld hits, %lld misses, %.1f%% hit rate, %d entries, %.2f of %.0f MB\n",
+             requests,
+             (long long)s->errors,
+             uptime,
+             uptime > 0 ? requests / uptime : 0.0,
+             requests ? s->busy_us / 1000.0 / requests : 0.0,
+             hits,
+             misses,
+             hits + misses ? 100.0 * hits / (hits + misses) : 0.0,
+             entries,
+             bytes / 1048576.0,
+             s->lru->max_bytes / 1048576.0);
+
+    return text;
+}
+
+static void serve_connection(server_state *s, int fd)
+{
+    std::vector<char> request;
+    char buf[4096];
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SERVER_READ_TIMEOUT_MS);
+    bool timeout = false;
+
+    for (;;)
+    {
+        // the deadline is for the whole request, not for each read
+        long long left_us = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count();
+        struct timeval tv;
+
+        if (left_us <= 0)
+        {
+            timeout = true;
+            break;
+        }
+
+        tv.tv_sec = (time_t)(left_us / 1000000);
+        tv.tv_usec = (suseconds_t)(left_us % 1000000);
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+        ssize_t k = read(fd, buf, sizeof(buf));
+
+        if (k < 0 && errno == EINTR)
+            continue;
+
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            timeout = true;
+            break;
+        }
+
+        if (k <= 0 || request.size() + k > SERVER_REQUEST_MAX)
+            break;
+
+        request.insert(request.end(), buf, buf + k);
+    }
+
+    if (timeout)
+    {
+        reply_error(fd, "timeout");
+        close(fd);
+        s->requests++;
+        s->errors++;
+        return;
+    }
+
+    std::vector<char *> args;
+
+    for (size_t i = 0; !request.empty() && request.back() == '\0' && i < request.size(); i += strlen(&request[i]) + 1)
+        args.push_back(&request[i]);
+
+    if (args.empty())
+    {
+        reply_error(fd, "malformed request");
+        close(fd);
+        return;
+    }
+
+    if (args.size() == 1 && !strcmp(args[0], "stats"))
+    {
+        std::string text = server_stats(s);
+
+        reply_ok(fd, text.data(), text.size());
+        close(fd);
+        return;
+    }
+
+    if (args.size() == 1 && !strcmp(args[0], "stop"))
+    {
+        std::string text = server_stats(s);
+
+        reply_ok(fd, text.data(), text.size());
+        close(fd);
+
+        {
+            std::lock_guard<std::mutex> guard(s->lock);
+            s->stopping = true;
+        }
+
+        // wake up the accept() of the main thread
+        int wake = connect_unix(s->socket_path);
+
+        if (wake >= 0)
+            close(wake);
+
+        return;
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    char *data = NULL;
+    size_t size = 0;
+    FILE *out = open_memstream(&data, &size);
+    std::string err;
+    bool ok = false;
+
+    if (!out)
+        err = "out of memory";
+    else
+        ok = s->handler(s->ctx, (int)args.size(), &args[0], out, &err);
+
+    if (out && fclose(out))
+        ok = false;
+
+    if (ok)
+        reply_ok(fd, data, size);
+    else
+        reply_error(fd, err.empty() ? "generation failed, see the server log" : err);
+
+    free(data);
+    close(fd);
+
+    s->requests++;
+
+    if (!ok)
+        s->errors++;
+
+    s->busy_us += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void server_worker(server_state *s)
+{
+    for (;;)
+    {
+        int fd;
+
+        {
+            std::unique_lock<std::mutex> guard(s->lock);
+
+            while (s->queue.empty() && !s->stopping)
+                s->ready.wait(guard);
+
+            if (s->queue.empty())
+                return;
+
+            fd = s->queue.front();
+            s->queue.pop_front();
+        }
+
+        serve_connection(s, fd);
+    }
+}
+
+int run_server(const char *socket_path, int num_threads, matrix_lru *lru, server_handler handler, void *ctx)
+{
+    sockaddr_un addr;
+
+    // a client that goes away must not take the server down with it
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!unix_address(socket_path, &addr))
+    {
+        fprintf(stderr, "\n\terror: socket path too long %s\n", socket_path);
+        return 1;
+    }
+
+    // a live server answers on the path, a stale socket file is replaced
+    int probe = connect_unix(socket_path);
+
+    if (probe >= 0)
+    {
+        close(probe);
+        fprintf(stderr, "\n\terror: a server is already running on %s\n", socket_path);
+        return 1;
+    }
+
+    unlink(socket_path);
+
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listen_fd < 0 || bind(listen_fd, (const sockaddr *)&addr, sizeof(addr)) || listen(listen_fd, 128))
+    {
+        fprintf(stderr, "\n\terror: cannot listen on %s\n", socket_path);
+
+        if (listen_fd >= 0)
+            close(listen_fd);
+        return 1;
+    }
+
+    server_state s;
+
+    s.socket_path = socket_path;
+    s.lru = lru;
+    s.handler = handler;
+    s.ctx = ctx;
+    s.stopping = false;
+    s.start = std::chrono::steady_clock::now();
+    s.requests = 0;
+    s.errors = 0;
+    s.busy_us = 0;
+
+    fprintf(stderr, "crc-gen: serving on %s, %d threads, %.0f MB matrix cache\n",
+            socket_path, num_threads, lru->max_bytes / 1048576.0);
+
+    std::vector<std::thread> workers;
+
+    for (int t = 0; t < num_threads; t++)
+        workers.emplace_back(server_worker, &s);
+
+    for (;;)
+    {
+        int fd = accept(listen_fd, NULL, NULL);
+        std::lock_guard<std::mutex> guard(s.lock);
+
+        if (s.stopping)
+        {
+            if (fd >= 0)
+                close(fd);
+            break;
+        }
+
+        if (fd < 0)
+        {
+            if (errno == EBADF || errno == EINVAL)
+                break;
+            continue;
+        }
+
+        s.queue.push_back(fd);
+        s.ready.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(s.lock);
+        s.stopping = true;
+    }
+
+    s.ready.notify_all();
+
+    for (size_t t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    close(listen_fd);
+    unlink(socket_path);
+
+    fprintf(stderr, "crc-gen: stopped, %s", server_stats(&s).c_str());
+
+    return 0;
+}
+
+int run_client(const char *socket_path, int argc, char **argv, const char *out_path)
+{
+    int fd = connect_unix(socket_path);
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "\n\terror: cannot connect to the server on %s\n", socket_path);
+        return 1;
+    }
+
+    std::string request;
+
+    for (int i = 0; i < argc; i++)
+    {
+        request += argv[i];
+        request.push_back('\0');
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    if (!write_all(fd, request.data(), request.size()) || shutdown(fd, SHUT_WR))
+    {
+        fprintf(stderr, "\n\terror: cannot send the request to %s\n", socket_path);
+        close(fd);
+        return 1;
+    }
+
+    // the status line, then the output
+    std::string head;
+    char c;
+
+    while (head.size() < 4096)
+    {
+        ssize_t k = read(fd, &c, 1);
+
+        if (k < 0 && errno == EINTR)
+            continue;
+
+        if (k <= 0 || c == '\n')
+            break;
+
+        head.push_back(c);
+    }
+
+    unsigned long long size;
+
+    if (!strncmp(head.c_str(), "error ", 6))
+    {
+        fprintf(stderr, "\n\terror: %s\n", head.c_str() + 6);
+        close(fd);
+        return 1;
+    }
+
+    if (sscanf(head.c_str(), "ok %llu", &size) != 1)
+    {
+        fprintf(stderr, "\n\terror: no reply from the server on %s\n", socket_path);
+        close(fd);
+        return 1;
+    }
+
+    emit_buf out;
+
+    if (!emit_open(&out, out_path, (size_t)1 << 20))
+    {
+        fprintf(stderr, "\n\terror: cannot open output file %s\n", out_path);
+        close(fd);
+        return 1;
+    }
+
+    unsigned long long got = 0;
+    char buf[65536];
+
+    for (;;)
+    {
+        ssize_t k = read(fd, buf, sizeof(buf));
+
+        if (k < 0 && errno == EINTR)
+            continue;
+
+        if (k <= 0)
+            break;
+
+        emit_mem(&out, buf, (size_t)k);
+        got += (unsigned long long)k;
+    }
+
+    close(fd);
+
+    // a short reply leaves the old output file in place
+    if (got != size)
+        out.failed = true;
+
+    if (!emit_close(&out))
+    {
+        if (got != size)
+            fprintf(stderr, "\n\terror: incomplete reply from the server on %s\n", socket_path);
+        else
+            fprintf(stderr, "\n\terror: failed to write output %s\n", out_path ? out_path : "");
+        return 1;
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+
+#include <string>
+
+#include "matrix_lru.h"
+
+//
+// generation server on a Unix domain socket
+//
+// a request is the command line arguments of one generation, each ended by
+// a NUL byte, after which the client shuts down its sending side. the reply
+// is a line "ok <bytes>" followed by that many bytes of output, or a line
+// "error <message>". the requests "stats" and "stop" report the request
+// rate and the cache hit rate, and shut the server down.
+//
+// connections are queued to num_threads workers, the matrices of all of
+// them are kept in one matrix_lru. not available on Windows.
+//
+
+// print the output of the request to out and return true, or set err
+typedef bool (*server_handler)(void *ctx, int argc, char **argv, FILE *out, std::string *err);
+
+// serve until a "stop" request, returns the exit status
+int run_server(const char *socket_path, int num_threads, matrix_lru *lru, server_handler handler, void *ctx);
+
+// send a request and write its output to out_path, stdout if NULL. returns
+// the exit status
+int run_client(const char *socket_path, int argc, char **argv, const char *out_path);
+
+#endif // SERVER_H
@@ -0,0 +1,691 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdlib.h>
+
+#include <chrono>
+
+#include "soft_crc.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOFT_CRC_X86 1
+#include <immintrin.h>
+#endif
+
+static uint64_t width_mask(int width)
+{
+    return width == 64 ? ~(uint64_t)0 : ((uint64_t)1 << width) - 1;
+}
+
+// the low width bits of v, bit reversed
+static uint64_t reflect(uint64_t v, int width)
+{
+    uint64_t r = 0;
+
+    for (int i = 0; i < width; i++, v >>= 1)
+        r = (r << 1) | (v & 1);
+
+    return r;
+}
+
+static inline uint64_t load_le64(const uint8_t *p)
+{
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+           (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+}
+
+static inline uint64_t load_be64(const uint8_t *p)
+{
+    return (uint64_t)p[0] << 56 | (uint64_t)p[1] << 48 | (uint64_t)p[2] << 40 | (uint64_t)p[3] << 32 |
+           (uint64_t)p[4] << 24 | (uint64_t)p[5] << 16 | (uint64_t)p[6] << 8 | (uint64_t)p[7];
+}
+
+// x^k mod f, right aligned
+static uint64_t xpow_mod(const soft_crc *c, int k)
+{
+    uint64_t r = 1;
+
+    for (int i = 0; i < k; i++)
+    {
+        uint64_t top = (r >> (c->width - 1)) & 1;
+
+        r = (r << 1) & width_mask(c->width);
+
+        if (top)
+            r ^= c->poly;
+    }
+
+    return r;
+}
+
+void soft_crc_setup(soft_crc *c,
+                    int width,
+                    const gf2_word *poly,
+                    const gf2_word *init,
+                    const gf2_word *xorout,
+                    bool refin,
+                    bool refout)
+{
+    uint64_t mask = width_mask(width);
+
+    c->width = width;
+    c->refin = refin;
+    c->refout = refout;
+    c->poly = (poly[0] & mask) | 1;
+    c->init = init ? init[0] & mask : mask;
+    c->xorout = xorout ? xorout[0] & mask : 0;
+
+    // one byte from zero, then every further table is one more zero byte
+    uint64_t rpoly = reflect(c->poly, width);
+    uint64_t lpoly = c->poly << (64 - width);
+
+    for (int b = 0; b < 256; b++)
+    {
+        uint64_t r = refin ? (uint64_t)b : (uint64_t)b << 56;
+
+        for (int i = 0; i < 8; i++)
+        {
+            if (refin)
+                r = (r & 1) ? (r >> 1) ^ rpoly : r >> 1;
+            else
+                r = (r >> 63) ? (r << 1) ^ lpoly : r << 1;
+        }
+
+        c->table[0][b] = r;
+    }
+
+    for (int k = 1; k < 16; k++)
+    {
+        for (int b = 0; b < 256; b++)
+        {
+            uint64_t t = c->table[k - 1][b];
+
+            c->table[k][b] = refin ? (t >> 8) ^ c->table[0][t & 0xff] : (t << 8) ^ c->table[0][t >> 56];
+        }
+    }
+
+    // a 128 bit block X = Xh*x^64 + Xl followed by the block B folds to
+    // Xh*(x^192 mod f) + Xl*(x^128 mod f) + B, which has the same remainder.
+    // bit reversed lanes multiply to the product shifted down by one, which
+    // x^191 and x^127 make up for.
+    if (refin)
+    {
+        c->fold_128[0] = reflect(xpow_mod(c, 191), 64);
+        c->fold_128[1] = reflect(xpow_mod(c, 127), 64);
+        c->fold_512[0] = reflect(xpow_mod(c, 575), 64);
+        c->fold_512[1] = reflect(xpow_mod(c, 511), 64);
+    }
+    else
+    {
+        c->fold_128[0] = xpow_mod(c, 128);
+        c->fold_128[1] = xpow_mod(c, 192);
+        c->fold_512[0] = xpow_mod(c, 512);
+        c->fold_512[1] = xpow_mod(c, 576);
+    }
+
+} // soft_crc_setup
+
+uint64_t soft_crc_start(const soft_crc *c)
+{
+    return c->refin ? reflect(c->init, c->width) : c->init << (64 - c->width);
+}
+
+uint64_t soft_crc_final(const soft_crc *c, uint64_t reg)
+{
+    // back to lfsr_q, then the output stage of the HDL
+    uint64_t lfsr_q = c->refin ? reflect(reg, c->width) : reg >> (64 - c->width);
+
+    if (c->refout)
+        lfsr_q = reflect(lfsr_q, c->width);
+
+    return lfsr_q ^ c->xorout;
+}
+
+// the HDL shift on lfsr_q itself, independent of the tables
+static uint64_t update_bitwise(const soft_crc *c, uint64_t reg, const uint8_t *p, size_t len)
+{
+    uint64_t mask = width_mask(c->width);
+    uint64_t lfsr_q = c->refin ? reflect(reg, c->width) : reg >> (64 - c->width);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        for (int j = 0; j < 8; j++)
+        {
+            uint64_t d = (p[i] >> (c->refin ? j : 7 - j)) & 1;
+            uint64_t fb = ((lfsr_q >> (c->width - 1)) & 1) ^ d;
+
+            lfsr_q = (lfsr_q << 1) & mask;
+
+            if (fb)
+                lfsr_q ^= c->poly;
+        }
+    }
+
+    return c->refin ? reflect(lfsr_q, c->width) : lfsr_q << (64 - c->width);
+}
+
+static inline uint64_t update_bytes(const soft_crc *c, uint64_t reg, const uint8_t *p, size_t len)
+{
+    if (c->refin)
+    {
+        for (size_t i = 0; i < len; i++)
+            reg = (reg >> 8) ^ c->table[0][(reg ^ p[i]) & 0xff];
+    }
+    else
+    {
+        for (size_t i = 0; i < len; i++)
+            reg = (reg << 8) ^ c->table[0][(reg >> 56) ^ p[i]];
+    }
+
+    return reg;
+}
+
+//
+// the register is xored into the first 8 bytes, after that every byte k of
+// a block contributes table[bytes left after it][byte] independently
+//
+static uint64_t update_slice8(const soft_crc *c, uint64_t reg, const uint8_t *p, size_t len)
+{
+    const uint64_t(*t)[256] = c->table;
+
+    for (; len >= 8; p += 8, len -= 8)
+    {
+        if (c->refin)
+        {
+            uint64_t a = load_le64(p) ^ reg;
+
+            reg = t[7][a & 0xff] ^ t[6][(a >> 8) & 0xff] ^ t[5][(a >> 16) & 0xff] ^ t[4][(a >> 24) & 0xff] ^
+                  t[3][(a >> 32) & 0xff] ^ t[2][(a >> 40) & 0xff] ^ t[1][(a >> 48) & 0xff] ^ t[0][a >> 56];
+        }
+        else
+        {
+            uint64_t a = load_be64(p) ^ reg;
+
+            reg = t[7][a >> 56] ^ t[6][(a >> 48) & 0xff] ^ t[5][(a >> 40) & 0xff] ^ t[4][(a >> 32) & 0xff] ^
+                  t[3][(a >> 24) & 0xff] ^ t[2][(a >> 16) & 0xff] ^ t[1][(a >> 8) & 0xff] ^ t[0][a & 0xff];
+        }
+    }
+
+    return update_bytes(c, reg, p, len);
+}
+
+static uint64_t update_slice16(const soft_crc *c, uint64_t reg, const uint8_t *p, size_t len)
+{
+    const uint64_t(*t)[256] = c->table;
+
+    for (; len >= 16; p += 16, len -= 16)
+    {
+        if (c->refin)
+        {
+            uint64_t a = load_le64(p) ^ reg;
+            uint64_t b = load_le64(p + 8);
+
+            reg = t[15][a & 0xff] ^ t[14][(a >> 8) & 0xff] ^ t[13][(a >> 16) & 0xff] ^ t[12][(a >> 24) & 0xff] ^
+                  t[11][(a >> 32) & 0xff] ^ t[10][(a >> 40) & 0xff] ^ t[9][(a >> 48) & 0xff] ^ t[8][a >> 56] ^
+                  t[7][b & 0xff] ^ t[6][(b >> 8) & 0xff] ^ t[5][(b >> 16) & 0xff] ^ t[4][(b >> 24) & 0xff] ^
+                  t[3][(b >> 32) & 0xff] ^ t[2][(b >> 40) & 0xff] ^ t[1][(b >> 48) & 0xff] ^ t[0][b >> 56];
+        }
+        else
+        {
+            uint64_t a = load_be64(p) ^ reg;
+            uint64_t b = load_be64(p + 8);
+
+            reg = t[15][a >> 56] ^ t[14][(a >> 48) & 0xff] ^ t[13][(a >> 40) & 0xff] ^ t[12][(a >> 32) & 0xff] ^
+                  t[11][(a >> 24) & 0xff] ^ t[10][(a >> 16) & 0xff] ^ t[9][(a >> 8) & 0xff] ^ t[8][a & 0xff] ^
+                  t[7][b >> 56] ^ t[6][(b >> 48) & 0xff] ^ t[5][(b >> 40) & 0xff] ^ t[4][(b >> 32) & 0xff] ^
+                  t[3][(b >> 24) & 0xff] ^ t[2][(b >> 16) & 0xff] ^ t[1][(b >> 8) & 0xff] ^ t[0][b & 0xff];
+        }
+    }
+
+    return update_bytes(c, reg, p, len);
+}
+
+#ifdef SOFT_CRC_X86
+
+__attribute__((target("pclmul,ssse3"))) static inline __m128i clmul_fold(__m128i x, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+//
+// four 128 bit accumulators run 64 bytes apart, then fold into one and its
+// 16 bytes go through the tables from a zero register. non reflected input
+// is byte swapped so that bit 127 of a block is its first bit.
+//
+__attribute__((target("pclmul,ssse3"))) static uint64_t update_clmul(const soft_crc *c, uint64_t reg, const uint8_t *p, size_t len)
+{
+    if (len < 128)
+        return update_slice16(c, reg, p, len);
+
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k128 = _mm_set_epi64x((long long)c->fold_128[1], (long long)c->fold_128[0]);
+    const __m128i k512 = _mm_set_epi64x((long long)c->fold_512[1], (long long)c->fold_512[0]);
+    __m128i x[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        x[i] = _mm_loadu_si128((const __m128i *)(p + 16 * i));
+
+        if (!c->refin)
+            x[i] = _mm_shuffle_epi8(x[i], bswap);
+    }
+
+    x[0] = _mm_xor_si128(x[0], c->refin ? _mm_set_epi64x(0, (long long)reg) : _mm_set_epi64x((long long)reg, 0));
+
+    for (p += 64, len -= 64; len >= 64; p += 64, len -= 64)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            __m128i b = _mm_loadu_si128((const __m128i *)(p + 16 * i));
+
+            if (!c->refin)
+                b = _mm_shuffle_epi8(b, bswap);
+
+            x[i] = _mm_xor_si128(clmul_fold(x[i], k512), b);
+        }
+    }
+
+    for (int i = 1; i < 4; i++)
+        x[0] = _mm_xor_si128(clmul_fold(x[0], k128), x[i]);
+
+    for (; len >= 16; p += 16, len -= 16)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i *)p);
+
+        if (!c->refin)
+            b = _mm_shuffle_epi8(b, bswap);
+
+        x[0] = _mm_xor_si128(clmul_fold(x[0], k128), b);
+    }
+
+    uint8_t folded[16];
+
+    if (!c->refin)
+        x[0] = _mm_shuffle_epi8(x[0], bswap);
+
+    _mm_storeu_si128((__m128i *)folded, x[0]);
+
+    return update_bytes(c, update_slice16(c, 0, folded, 16), p, len);
+
+} // update_clmul
+
+#endif // SOFT_CRC_X86
+
+bool soft_crc_have_clmul()
+{
+#ifdef SOFT_CRC_X86
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+#else
+    return false;
+#endif
+}
+
+uint64_t soft_crc_update(const soft_crc *c, uint64_t reg, const uint8_t *p, size_t len, soft_crc_method method)
+{
+    switch (method)
+    {
+    case SOFT_CRC_BITWISE:
+        return update_bitwise(c, reg, p, len);
+    case SOFT_CRC_SLICE8:
+        return update_slice8(c, reg, p, len);
+#ifdef SOFT_CRC_X86
+    case SOFT_CRC_CLMUL:
+        if (soft_crc_have_clmul())
+            return update_clmul(c, reg, p, len);
+        return update_slice16(c, reg, p, len);
+#endif
+    default:
+        return update_slice16(c, reg, p, len);
+    }
+}
+
+const char *soft_crc_method_name(soft_crc_method method)
+{
+    static const char *names[SOFT_CRC_METHODS] = {"bitwise", "slice8", "slice16", "clmul"};
+
+    return names[method];
+}
+
+uint64_t soft_crc_check(const soft_crc *c)
+{
+    return soft_crc_final(c, soft_crc_update(c, soft_crc_start(c), (const uint8_t *)"123456789", 9, SOFT_CRC_BITWISE));
+}
+
+//
+// every method runs over the whole buffer until 0.25 s have passed, the
+// bitwise reference only checks an odd sized, unaligned piece of it
+//
+bool soft_crc_bench(FILE *fp, const char *name, const soft_crc *c, size_t bytes)
+{
+    uint8_t *buf = (uint8_t *)malloc(bytes + 1);
+
+    if (!buf)
+    {
+        fprintf(fp, "%s: no memory for a %llu byte buffer\n", name, (unsigned long long)bytes);
+        return false;
+    }
+
+    uint64_t s = 0x9e3779b97f4a7c15ull;
+
+    for (size_t i = 0; i <= bytes; i++)
+    {
+        s ^= s << 13;
+        s ^= s >> 7;
+        s ^= s << 17;
+        buf[i] = (uint8_t)s;
+    }
+
+    fprintf(fp, "%s: check    0x%0*llx\n", name, (c->width + 3) / 4, (unsigned long long)soft_crc_check(c));
+
+    size_t ref_len = bytes < ((size_t)1 << 20) ? bytes : ((size_t)1 << 20) - 3;
+    uint64_t ref = soft_crc_final(c, soft_crc_update(c, soft_crc_start(c), buf + 1, ref_len, SOFT_CRC_BITWISE));
+    uint64_t all = 0;
+    bool ok = true;
+
+    for (int m = SOFT_CRC_SLICE8; m < SOFT_CRC_METHODS; m++)
+    {
+        soft_crc_method method = (soft_crc_method)m;
+
+        if (soft_crc_final(c, soft_crc_update(c, soft_crc_start(c), buf + 1, ref_len, method)) != ref)
+        {
+            fprintf(fp, "%s: %s disagrees with the bitwise reference\n", name, soft_crc_method_name(method));
+            ok = false;
+        }
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        double elapsed;
+        uint64_t crc;
+        int runs = 0;
+
+        do
+        {
+            crc = soft_crc_final(c, soft_crc_update(c, soft_crc_start(c), buf, bytes, method));
+            runs++;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        } while (elapsed < 0.25);
+
+        if (m == SOFT_CRC_SLICE8)
+            all = crc;
+        else if (crc != all)
+        {
+            fprintf(fp, "%s: %s disagrees with slice8\n", name, soft_crc_method_name(method));
+            ok = false;
+        }
+
+        fprintf(fp, "%s: %-8s %7.2f GB/s%s\n",
+                name,
+                soft_crc_method_name(method),
+                (double)bytes * runs / elapsed / 1e9,
+                method == SOFT_CRC_CLMUL && !soft_crc_have_clmul() ? " (no pclmul, slice16)" : "");
+    }
+
+    free(buf);
+
+    return ok;
+
+} // soft_crc_bench
+
+//
+// generate a C header for this CRC
+//
+// the register of the header is the smallest of 8, 16, 32 or 64 bits that
+// holds the CRC, laid out like the 64 bit register of the engine. the header
+// only carries the code for its own input order.
+//
+void print_c_crc(emit_buf *out, const soft_crc *c, int num_data_bits)
+{
+    int N = c->width;
+    int W = N <= 8 ? 8 : N <= 16 ? 16 : N <= 32 ? 32 : 64;
+    int digits = W / 4;
+    const char *suffix = W == 64 ? "ull" : "u";
+    uint64_t start = soft_crc_start(c);
+
+    if (!c->refin)
+        start >>= 64 - W;
+
+    EMIT_LIT(out, "\n//-----------------------------------------------------------------------------");
+    EMIT_LIT(out, "\n// CRC for");
+    emit_fmt(out, "\n//    crc[%d:0]=", N - 1);
+
+    for (int l = 0; l < N; l++)
+    {
+        if (!((c->poly >> l) & 1))
+            continue;
+
+        if (l)
+            emit_fmt(out, "+x^%d", l);
+        else
+            EMIT_LIT(out, "1");
+    }
+
+    emit_fmt(out, "+x^%d;", N);
+    EMIT_LIT(out, "\n// the same CRC as the generated HDL with INIT, OUTPUT_XOR, INPUT_INV and");
+    emit_fmt(out, "\n// OUTPUT_INV as below, for a byte stream packed into data[%d:0] with the", num_data_bits - 1);
+    emit_fmt(out, "\n// first byte in the %s bits", c->refin ? "low" : "top");
+    EMIT_LIT(out, "\n//-----------------------------------------------------------------------------\n\n");
+
+    EMIT_LIT(out, "#ifndef CRC_H\n");
+    EMIT_LIT(out, "#define CRC_H\n\n");
+    EMIT_LIT(out, "#include <stddef.h>\n");
+    EMIT_LIT(out, "#include <stdint.h>\n\n");
+
+    emit_fmt(out, "typedef uint%d_t crc_t;\n\n", W);
+
+    emit_fmt(out, "#define CRC_WIDTH      %d\n", N);
+    emit_fmt(out, "#define CRC_POLY       0x%0*llx%s\n", digits, (unsigned long long)c->poly, suffix);
+    emit_fmt(out, "#define CRC_INIT       0x%0*llx%s\n", digits, (unsigned long long)c->init, suffix);
+    emit_fmt(out, "#define CRC_OUTPUT_XOR 0x%0*llx%s\n", digits, (unsigned long long)c->xorout, suffix);
+    emit_fmt(out, "#define CRC_INPUT_INV  %d\n", c->refin ? 1 : 0);
+    emit_fmt(out, "#define CRC_OUTPUT_INV %d\n", c->refout ? 1 : 0);
+    emit_fmt(out, "#define CRC_CHECK      0x%0*llx%s // \"123456789\"\n\n", digits, (unsigned long long)soft_crc_check(c), suffix);
+
+    emit_fmt(out, "// crc_table[k][b]: register after byte b and k zero bytes, %s\n",
+             c->refin ? "bit reversed" : "left aligned");
+    EMIT_LIT(out, "static const crc_t crc_table[16][256] = {");
+
+    for (int k = 0; k < 16; k++)
+    {
+        EMIT_LIT(out, "\n    {");
+
+        for (int b = 0; b < 256; b++)
+        {
+            uint64_t t = c->refin ? c->table[k][b] : c->table[k][b] >> (64 - W);
+
+            emit_str(out, b % 8 ? " " : "\n        ");
+            emit_fmt(out, "0x%0*llx%s,", digits, (unsigned long long)t, suffix);
+        }
+
+        EMIT_LIT(out, "\n    },");
+    }
+
+    EMIT_LIT(out, "\n};\n\n");
+
+    EMIT_LIT(out, "static inline uint64_t crc_load64(const uint8_t *p)\n");
+    EMIT_LIT(out, "{\n");
+
+    if (c->refin)
+    {
+        EMIT_LIT(out, "    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |\n");
+        EMIT_LIT(out, "           (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;\n");
+    }
+    else
+    {
+        EMIT_LIT(out, "    return (uint64_t)p[0] << 56 | (uint64_t)p[1] << 48 | (uint64_t)p[2] << 40 | (uint64_t)p[3] << 32 |\n");
+        EMIT_LIT(out, "           (uint64_t)p[4] << 24 | (uint64_t)p[5] << 16 | (uint64_t)p[6] << 8 | (uint64_t)p[7];\n");
+    }
+
+    EMIT_LIT(out, "}\n\n");
+
+    if (c->refin != c->refout)
+    {
+        EMIT_LIT(out, "static inline crc_t crc_reflect(crc_t v)\n");
+        EMIT_LIT(out, "{\n");
+        EMIT_LIT(out, "    crc_t r = 0;\n\n");
+        EMIT_LIT(out, "    for (int i = 0; i < CRC_WIDTH; i++, v >>= 1)\n");
+        EMIT_LIT(out, "        r = (crc_t)((r << 1) | (v & 1));\n\n");
+        EMIT_LIT(out, "    return r;\n");
+        EMIT_LIT(out, "}\n\n");
+    }
+
+    EMIT_LIT(out, "static inline crc_t crc_init(void)\n");
+    EMIT_LIT(out, "{\n");
+    emit_fmt(out, "    return 0x%0*llx%s; // CRC_INIT %s\n", digits, (unsigned long long)start, suffix,
+             c->refin ? "bit reversed" : "left aligned");
+    EMIT_LIT(out, "}\n\n");
+
+    EMIT_LIT(out, "static inline crc_t crc_final(crc_t crc)\n");
+    EMIT_LIT(out, "{\n");
+
+    if (!c->refin && N < W)
+        emit_fmt(out, "    crc = (crc_t)(crc >> %d);\n", W - N);
+
+    if (c->refin != c->refout)
+        EMIT_LIT(out, "    crc = crc_reflect(crc);\n");
+
+    EMIT_LIT(out, "    return (crc_t)(crc ^ CRC_OUTPUT_XOR);\n");
+    EMIT_LIT(out, "}\n\n");
+
+    // slicing by 16, the register goes into the first bytes of each block
+    EMIT_LIT(out, "static inline crc_t crc_update_table(crc_t crc, const uint8_t *p, size_t len)\n");
+    EMIT_LIT(out, "{\n");
+    EMIT_LIT(out, "    for (; len >= 16; p += 16, len -= 16)\n");
+    EMIT_LIT(out, "    {\n");
+
+    if (c->refin || W == 64)
+        EMIT_LIT(out, "        uint64_t a = crc_load64(p) ^ crc;\n");
+    else
+        emit_fmt(out, "        uint64_t a = crc_load64(p) ^ (uint64_t)crc << %d;\n", 64 - W);
+
+    EMIT_LIT(out, "        uint64_t b = crc_load64(p + 8);\n\n");
+    EMIT_LIT(out, "        crc = ");
+
+    for (int k = 15; k >= 0; k--)
+    {
+        int shift = c->refin ? 8 * (7 - k % 8) : 8 * (k % 8);
+
+        emit_fmt(out, "crc_table[%d][", k);
+
+        if (shift == 56)
+            emit_fmt(out, "%c >> 56]", k >= 8 ? 'a' : 'b');
+        else if (shift)
+            emit_fmt(out, "(%c >> %d) & 0xff]", k >= 8 ? 'a' : 'b', shift);
+        else
+            emit_fmt(out, "%c & 0xff]", k >= 8 ? 'a' : 'b');
+
+        emit_str(out, k ? " ^\n              " : ";\n");
+    }
+
+    EMIT_LIT(out, "    }\n\n");
+    EMIT_LIT(out, "    while (len--)\n");
+
+    if (c->refin)
+        EMIT_LIT(out, "        crc = (crc_t)((crc >> 8) ^ crc_table[0][(crc ^ *p++) & 0xff]);\n\n");
+    else
+        emit_fmt(out, "        crc = (crc_t)((crc << 8) ^ crc_table[0][((crc >> %d) ^ *p++) & 0xff]);\n\n", W - 8);
+
+    EMIT_LIT(out, "    return crc;\n");
+    EMIT_LIT(out, "}\n\n");
+
+    // carry-less multiply folding, see soft_crc_setup for the constants
+    EMIT_LIT(out, "#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(CRC_NO_CLMUL)\n");
+    EMIT_LIT(out, "#include <immintrin.h>\n\n");
+    EMIT_LIT(out, "#define CRC_HAVE_CLMUL 1\n\n");
+
+    EMIT_LIT(out, "// x^k mod poly for the {low, high} lane, folding 16 and 64 bytes ahead\n");
+    emit_fmt(out, "static const uint64_t crc_fold_128[2] = {0x%016llxull, 0x%016llxull};\n",
+             (unsigned long long)c->fold_128[0], (unsigned long long)c->fold_128[1]);
+    emit_fmt(out, "static const uint64_t crc_fold_512[2] = {0x%016llxull, 0x%016llxull};\n\n",
+             (unsigned long long)c->fold_512[0], (unsigned long long)c->fold_512[1]);
+
+    EMIT_LIT(out, "__attribute__((target(\"pclmul,ssse3\"))) static inline __m128i crc_load128(const uint8_t *p)\n");
+    EMIT_LIT(out, "{\n");
+
+    if (c->refin)
+        EMIT_LIT(out, "    return _mm_loadu_si128((const __m128i *)p);\n");
+    else
+        EMIT_LIT(out, "    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));\n");
+
+    EMIT_LIT(out, "}\n\n");
+
+    EMIT_LIT(out, "__attribute__((target(\"pclmul,ssse3\"))) static inline __m128i crc_fold(__m128i x, __m128i k, __m128i b)\n");
+    EMIT_LIT(out, "{\n");
+    EMIT_LIT(out, "    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11)), b);\n");
+    EMIT_LIT(out, "}\n\n");
+
+    EMIT_LIT(out, "// len >= 64\n");
+    EMIT_LIT(out, "__attribute__((target(\"pclmul,ssse3\"))) static inline crc_t crc_update_clmul(crc_t crc, const uint8_t *p, size_t len)\n");
+    EMIT_LIT(out, "{\n");
+    EMIT_LIT(out, "    const __m128i k128 = _mm_set_epi64x((long long)crc_fold_128[1], (long long)crc_fold_128[0]);\n");
+    EMIT_LIT(out, "    const __m128i k512 = _mm_set_epi64x((long long)crc_fold_512[1], (long long)crc_fold_512[0]);\n");
+
+    if (c->refin)
+        EMIT_LIT(out, "    __m128i x0 = _mm_xor_si128(crc_load128(p), _mm_set_epi64x(0, (long long)crc));\n");
+    else
+        emit_fmt(out, "    __m128i x0 = _mm_xor_si128(crc_load128(p), _mm_set_epi64x((long long)((uint64_t)crc << %d), 0));\n", 64 - W);
+
+    EMIT_LIT(out, "    __m128i x1 = crc_load128(p + 16);\n");
+    EMIT_LIT(out, "    __m128i x2 = crc_load128(p + 32);\n");
+    EMIT_LIT(out, "    __m128i x3 = crc_load128(p + 48);\n");
+    EMIT_LIT(out, "    uint8_t folded[16];\n\n");
+    EMIT_LIT(out, "    for (p += 64, len -= 64; len >= 64; p += 64, len -= 64)\n");
+    EMIT_LIT(out, "    {\n");
+    EMIT_LIT(out, "        x0 = crc_fold(x0, k512, crc_load128(p));\n");
+    EMIT_LIT(out, "        x1 = crc_fold(x1, k512, crc_load128(p + 16));\n");
+    EMIT_LIT(out, "        x2 = crc_fold(x2, k512, crc_load128(p + 32));\n");
+    EMIT_LIT(out, "        x3 = crc_fold(x3, k512, crc_load128(p + 48));\n");
+    EMIT_LIT(out, "    }\n\n");
+    EMIT_LIT(out, "    x0 = crc_fold(crc_fold(crc_fold(x0, k128, x1), k128, x2), k128, x3);\n\n");
+    EMIT_LIT(out, "    for (; len >= 16; p += 16, len -= 16)\n");
+    EMIT_LIT(out, "        x0 = crc_fold(x0, k128, crc_load128(p));\n\n");
+
+    if (c->refin)
+        EMIT_LIT(out, "    _mm_storeu_si128((__m128i *)folded, x0);\n\n");
+    else
+        EMIT_LIT(out, "    _mm_storeu_si128((__m128i *)folded, _mm_shuffle_epi8(x0, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15)));\n\n");
+
+    EMIT_LIT(out, "    return crc_update_table(crc_update_table(0, folded, 16), p, len);\n");
+    EMIT_LIT(out, "}\n");
+    EMIT_LIT(out, "#endif\n\n");
+
+    EMIT_LIT(out, "static inline crc_t crc_update(crc_t crc, const void *data, size_t len)\n");
+    EMIT_LIT(out, "{\n");
+    EMIT_LIT(out, "#ifdef CRC_HAVE_CLMUL\n");
+    EMIT_LIT(out, "    if (len >= 128 && __builtin_cpu_supports(\"pclmul\") && __builtin_cpu_supports(\"ssse3\"))\n");
+    EMIT_LIT(out, "        return crc_update_clmul(crc, (const uint8_t *)data, len);\n");
+    EMIT_LIT(out, "#endif\n");
+    EMIT_LIT(out, "    return crc_update_table(crc, (const uint8_t *)data, len);\n");
+    EMIT_LIT(out, "}\n\n");
+
+    EMIT_LIT(out, "static inline crc_t crc_compute(const void *data, size_t len)\n");
+    EMIT_LIT(out, "{\n");
+    EMIT_LIT(out, "    return crc_final(crc_update(crc_init(), data, len));\n");
+    EMIT_LIT(out, "}\n\n");
+
+    EMIT_LIT(out, "#endif // CRC_H\n");
+
+} // print_c_crc
@@ -0,0 +1,108 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SOFT_CRC_H
+#define SOFT_CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "emit.h"
+#include "gf2.h"
+
+//
+// software CRC engine for the same parameters as the generated HDL
+//
+// the polynomial is f = poly|1 as in the HDL, init, xorout, refin and refout
+// are the INIT, OUTPUT_XOR, INPUT_INV and OUTPUT_INV generics. a byte stream
+// gives the same CRC as the HDL fed with the bytes packed into data_in with
+// the first byte in the top bits, or in the low bits when refin is set.
+//
+// the running register is 64 bits wide: bit reversed in the low width bits
+// when refin is set, else left aligned, so any width up to 64 uses the same
+// table code.
+//
+#define SOFT_CRC_WIDTH_MAX 64
+
+enum soft_crc_method
+{
+    SOFT_CRC_BITWISE, // one bit at a time, the reference
+    SOFT_CRC_SLICE8,
+    SOFT_CRC_SLICE16,
+    SOFT_CRC_CLMUL, // carry-less multiply folding, SLICE16 without pclmul
+    SOFT_CRC_METHODS
+};
+
+struct soft_crc
+{
+    int width;
+    bool refin;
+    bool refout;
+    uint64_t poly; // f, right aligned
+    uint64_t init;
+    uint64_t xorout;
+
+    // table[k][b] = register after byte b and k zero bytes from zero
+    uint64_t table[16][256];
+
+    // carry-less multiply lanes {low, high}: fold one 128 bit block over
+    // the next one, and over the block 64 bytes further
+    uint64_t fold_128[2];
+    uint64_t fold_512[2];
+};
+
+// width 1..SOFT_CRC_WIDTH_MAX, init and xorout NULL for the HDL defaults
+// (all ones and zero)
+void soft_crc_setup(soft_crc *c,
+                    int width,
+                    const gf2_word *poly,
+                    const gf2_word *init,
+                    const gf2_word *xorout,
+                    bool refin,
+                    bool refout);
+
+uint64_t soft_crc_start(const soft_crc *c);
+uint64_t soft_crc_update(const soft_crc *c, uint64_t reg, const uint8_t *p, size_t len, soft_crc_method method);
+uint64_t soft_crc_final(const soft_crc *c, uint64_t reg);
+
+// whether SOFT_CRC_CLMUL runs on pclmul on this machine
+bool soft_crc_have_clmul();
+
+const char *soft_crc_method_name(soft_crc_method method);
+
+// CRC of the ASCII string "123456789"
+uint64_t soft_crc_check(const soft_crc *c);
+
+// time every method over a buffer of 'bytes' and print GB/s to fp,
+// returns false if the methods disagree or the buffer can not be allocated
+bool soft_crc_bench(FILE *fp, const char *name, const soft_crc *c, size_t bytes);
+
+// self-contained C header with the tables and fold constants
+void print_c_crc(emit_buf *out, const soft_crc *c, int num_data_bits);
+
+#endif // SOFT_CRC_H
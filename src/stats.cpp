@@ -0,0 +1,199 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "cost.h"
+#include "stats.h"
+
+void crc_stats_init(crc_stats *s, int lfsr_poly_size, int num_data_bits)
+{
+    s->lfsr_poly_size = lfsr_poly_size;
+    s->num_data_bits = num_data_bits;
+    s->parse_s = 0;
+    s->build_s = 0;
+    s->print_s = 0;
+    s->bytes = 0;
+    s->q_terms.assign(lfsr_poly_size, 0);
+    s->data_terms.assign(lfsr_poly_size, 0);
+    s->data_fanout.assign(num_data_bits, 0);
+}
+
+void crc_stats_add_row(crc_stats *s, int n2, const gf2_word *row)
+{
+    int N = s->lfsr_poly_size;
+    int words = GF2_WORDS(N + s->num_data_bits);
+    int q = 0;
+    int d = 0;
+
+    for (int i = gf2_next_set(row, words, 0); i >= 0; i = gf2_next_set(row, words, i + 1))
+    {
+        if (i < N)
+        {
+            q++;
+        }
+        else
+        {
+            d++;
+            s->data_fanout[i - N]++;
+        }
+    }
+
+    s->q_terms[n2] = q;
+    s->data_terms[n2] = d;
+}
+
+struct crc_stats_summary
+{
+    int fan_in_max;
+    double fan_in_avg;
+    long long luts;
+    int lut_depth;
+    int fanout_max;
+    double fanout_avg;
+};
+
+static void summarize(const crc_stats *s, crc_stats_summary *sum)
+{
+    long long fan_in_total = 0;
+    long long fanout_total = 0;
+
+    sum->fan_in_max = 0;
+    sum->luts = 0;
+    sum->lut_depth = 0;
+    sum->fanout_max = 0;
+
+    for (int n2 = 0; n2 < s->lfsr_poly_size; n2++)
+    {
+        int k = s->q_terms[n2] + s->data_terms[n2];
+
+        fan_in_total += k;
+
+        if (k > sum->fan_in_max)
+            sum->fan_in_max = k;
+
+        sum->luts += lut6_count(k);
+
+        if (lut6_levels(k) > sum->lut_depth)
+            sum->lut_depth = lut6_levels(k);
+    }
+
+    for (int m = 0; m < s->num_data_bits; m++)
+    {
+        fanout_total += s->data_fanout[m];
+
+        if (s->data_fanout[m] > sum->fanout_max)
+            sum->fanout_max = s->data_fanout[m];
+    }
+
+    sum->fan_in_avg = (double)fan_in_total / s->lfsr_poly_size;
+    sum->fanout_avg = (double)fanout_total / s->num_data_bits;
+}
+
+void print_crc_stats(FILE *fp, const char *name, const crc_stats *s)
+{
+    crc_stats_summary sum;
+
+    summarize(s, &sum);
+
+    fprintf(fp, "%s: parse %.6f s, build %.6f s, print %.6f s, %llu bytes\n",
+            name,
+            s->parse_s,
+            s->build_s,
+            s->print_s,
+            (unsigned long long)s->bytes);
+    fprintf(fp, "%s: fan-in max %d avg %.2f, lut6 estimate %lld luts, depth %d\n",
+            name,
+            sum.fan_in_max,
+            sum.fan_in_avg,
+            sum.luts,
+            sum.lut_depth);
+
+    for (int n2 = 0; n2 < s->lfsr_poly_size; n2++)
+        fprintf(fp, "%s: lfsr_c[%d] = %d lfsr_q + %d data_in_inv_res terms\n", name, n2, s->q_terms[n2], s->data_terms[n2]);
+
+    fprintf(fp, "%s: data_in_inv_res fanout max %d avg %.2f\n", name, sum.fanout_max, sum.fanout_avg);
+
+    for (int m = 0; m < s->num_data_bits; m++)
+        fprintf(fp, "%s: data_in_inv_res[%d] fanout %d\n", name, m, s->data_fanout[m]);
+} // print_crc_stats
+
+static void write_int_array(FILE *fp, const char *key, const std::vector<int> &v, bool last)
+{
+    fprintf(fp, "  \"%s\": [", key);
+
+    for (size_t i = 0; i < v.size(); i++)
+        fprintf(fp, i ? ", %d" : "%d", v[i]);
+
+    fprintf(fp, "]%s\n", last ? "" : ",");
+}
+
+bool write_crc_stats_json(const char *path, const char *name, const crc_stats *s)
+{
+    FILE *fp = fopen(path, "w");
+    crc_stats_summary sum;
+
+    if (!fp)
+        return false;
+
+    summarize(s, &sum);
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"name\": \"");
+
+    // the only strings are file names, escape what JSON requires
+    for (const char *c = name; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', fp);
+        fputc(*c, fp);
+    }
+
+    fprintf(fp, "\",\n");
+    fprintf(fp, "  \"poly_width\": %d,\n", s->lfsr_poly_size);
+    fprintf(fp, "  \"data_width\": %d,\n", s->num_data_bits);
+    fprintf(fp, "  \"parse_s\": %.6f,\n", s->parse_s);
+    fprintf(fp, "  \"build_s\": %.6f,\n", s->build_s);
+    fprintf(fp, "  \"print_s\": %.6f,\n", s->print_s);
+    fprintf(fp, "  \"bytes\": %llu,\n", (unsigned long long)s->bytes);
+    fprintf(fp, "  \"fan_in_max\": %d,\n", sum.fan_in_max);
+    fprintf(fp, "  \"fan_in_avg\": %.4f,\n", sum.fan_in_avg);
+    fprintf(fp, "  \"lut6_count\": %lld,\n", sum.luts);
+    fprintf(fp, "  \"lut6_depth\": %d,\n", sum.lut_depth);
+    fprintf(fp, "  \"data_fanout_max\": %d,\n", sum.fanout_max);
+    fprintf(fp, "  \"data_fanout_avg\": %.4f,\n", sum.fanout_avg);
+    write_int_array(fp, "lfsr_q_terms", s->q_terms, false);
+    write_int_array(fp, "data_terms", s->data_terms, false);
+    write_int_array(fp, "data_fanout", s->data_fanout, true);
+    fprintf(fp, "}\n");
+
+    bool ok = !ferror(fp);
+
+    if (fclose(fp))
+        ok = false;
+
+    return ok;
+} // write_crc_stats_json
@@ -0,0 +1,72 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "gf2.h"
+
+//
+// --stats: phase timings and the size of the generated logic
+//
+// the logic numbers are taken from the flat equations, before --cse or
+// --pipeline rework them. the LUT6 estimate maps every lfsr_c bit to its own
+// tree of 6-input LUTs, k inputs take ceil((k-1)/5) LUTs in ceil(log6(k))
+// levels; crc_en is left to the flip-flop clock enable.
+//
+struct crc_stats
+{
+    int lfsr_poly_size;
+    int num_data_bits;
+
+    double parse_s;
+    double build_s;
+    double print_s;
+    size_t bytes;
+
+    std::vector<int> q_terms;     // lfsr_q inputs of lfsr_c[n2]
+    std::vector<int> data_terms;  // data_in_inv_res inputs of lfsr_c[n2]
+    std::vector<int> data_fanout; // equations using data_in_inv_res[m]
+};
+
+void crc_stats_init(crc_stats *s, int lfsr_poly_size, int num_data_bits);
+
+// account equation row of lfsr_c[n2], N state columns then M data columns
+void crc_stats_add_row(crc_stats *s, int n2, const gf2_word *row);
+
+void print_crc_stats(FILE *fp, const char *name, const crc_stats *s);
+
+// returns false if the file could not be written
+bool write_crc_stats_json(const char *path, const char *name, const crc_stats *s);
+
+#endif // STATS_H
@@ -0,0 +1,1009 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "bitslice.h"
+#include "channels.h"
+#include "emit.h"
+#include "testbench.h"
+
+// packets open at a time on a multi-channel core
+#define TB_CHANNEL_SLOTS 4
+
+//
+// SLICE_VECTORS packets with the data of every beat, already in data_in bit
+// order, and the LFSR state after it. a folded beat has the state after each
+// of its slices, the last one is the state after the whole beat.
+//
+struct tb_packets
+{
+    int beats[SLICE_VECTORS];
+    int last_bytes[SLICE_VECTORS]; // bytes of the last beat with --byte-enables
+    std::vector<gf2_word> data;    // packet t beat k at (t*TB_MAX_BEATS+k)*data words
+    std::vector<gf2_word> state;   // slice j at ((t*TB_MAX_BEATS+k)*fold+j)*state words
+};
+
+// a beat on its way through the pipeline
+struct tb_beat
+{
+    long long due; // cycle after which it shows on crc_out
+    const gf2_word *state;
+    int channel;
+};
+
+//
+// the cycle by cycle replay: the lfsr_q the core holds after each clock edge
+// and the beats still on their way through the pipeline
+//
+struct tb_timeline
+{
+    const testbench_params *p;
+    emit_buf *out;
+    long long cycle;
+    int crc_digits;
+    int data_digits;
+    int keep_digits;
+    int channel_digits;
+    int fold_cnt;    // clocks left of a folded beat, crc_ready when 0
+    int crc_channel; // channel of the last beat shown on crc_out
+    std::vector<gf2_word> lfsr_q;
+    std::deque<tb_beat> pending;
+    std::vector<gf2_word> crc_out;
+    std::vector<gf2_word> idle_data;
+    std::vector<gf2_word> keep;
+};
+
+static inline void lane_set(slice_lane *v, int t)
+{
+    v->w[t / GF2_WORD_BITS] |= (gf2_word)1 << (t % GF2_WORD_BITS);
+}
+
+// set bit 'bit' of vector k of every packet t selected by mask and set in v,
+// a packet holds 'vectors' vectors
+static void scatter_lane(const slice_lane *v, const slice_lane *mask, gf2_word *base, int vectors, int k, int words, int bit)
+{
+    for (int l = 0; l < SLICE_WORDS; l++)
+    {
+        for (gf2_word w = v->w[l] & mask->w[l]; w; w &= w - 1)
+        {
+            int t = l * GF2_WORD_BITS + gf2_ctz(w);
+
+            gf2_set(base + ((size_t)t * vectors + k) * words, bit);
+        }
+    }
+} // scatter_lane
+
+static void mask_top(gf2_word *v, int nbits)
+{
+    if (nbits % GF2_WORD_BITS)
+        v[GF2_WORDS(nbits) - 1] &= ((gf2_word)1 << (nbits % GF2_WORD_BITS)) - 1;
+}
+
+//
+// draw the next SLICE_VECTORS packets and run them through the bit-sliced
+// serial LFSR, data_in_inv_res[M-1] first, taking the state of a partial last
+// beat after its 8*last_bytes bits and of a folded beat after every slice
+//
+static void build_packets(const testbench_params *p, tb_packets *pk, uint64_t *seed)
+{
+    int N = p->lfsr_poly_size;
+    int M = p->num_data_bits;
+    int data_words = GF2_WORDS(M);
+    int state_words = GF2_WORDS(N);
+    int keep_bytes = p->byte_enables ? M / 8 : 0;
+    int fold = p->fold;
+    int slice_bits = M / fold;
+    int max_beats = 0;
+
+    for (int t = 0; t < SLICE_VECTORS; t++)
+    {
+        pk->beats[t] = 1 + (int)(splitmix64(seed) % TB_MAX_BEATS);
+        pk->last_bytes[t] = keep_bytes ? 1 + (int)(splitmix64(seed) % keep_bytes) : 0;
+
+        if (pk->beats[t] > max_beats)
+            max_beats = pk->beats[t];
+    }
+
+    pk->data.assign((size_t)SLICE_VECTORS * TB_MAX_BEATS * data_words, 0);
+    pk->state.assign((size_t)SLICE_VECTORS * TB_MAX_BEATS * fold * state_words, 0);
+
+    sliced_lfsr lfsr;
+
+    sliced_lfsr_init(&lfsr, N, p->lfsr_poly);
+
+    for (int n = 0; n < N; n++)
+    {
+        if (gf2_get(p->init, n))
+            memset(sliced_lfsr_bit(&lfsr, n), 0xff, sizeof(slice_lane));
+    }
+
+    // ends[b]: packets whose beat k is their last one with b bytes
+    std::vector<slice_lane> ends(keep_bytes + 1);
+
+    for (int k = 0; k < max_beats; k++)
+    {
+        slice_lane active = slice_lane();
+        slice_lane full;
+
+        ends.assign(keep_bytes + 1, slice_lane());
+
+        for (int t = 0; t < SLICE_VECTORS; t++)
+        {
+            if (k < pk->beats[t])
+                lane_set(&active, t);
+
+            if (keep_bytes && k == pk->beats[t] - 1)
+                lane_set(&ends[pk->last_bytes[t]], t);
+        }
+
+        for (int m = M - 1; m >= 0; m--)
+        {
+            slice_lane d;
+            int shifted = M - m;
+
+            lane_random(&d, seed);
+            sliced_lfsr_shift(&lfsr, &d);
+            scatter_lane(&d, &active, &pk->data[0], TB_MAX_BEATS, k, data_words, p->input_inv ? M - 1 - m : m);
+
+            if (keep_bytes && shifted % 8 == 0 && shifted / 8 < keep_bytes)
+            {
+                for (int n = 0; n < N; n++)
+                    scatter_lane(sliced_lfsr_bit(&lfsr, n), &ends[shifted / 8], &pk->state[0], TB_MAX_BEATS, k, state_words, n);
+            }
+
+            if (shifted % slice_bits == 0 && shifted < M)
+            {
+                for (int n = 0; n < N; n++)
+                    scatter_lane(sliced_lfsr_bit(&lfsr, n), &active, &pk->state[0], TB_MAX_BEATS * fold, k * fold + shifted / slice_bits - 1, state_words, n);
+            }
+        }
+
+        for (int l = 0; l < SLICE_WORDS; l++)
+        {
+            full.w[l] = active.w[l];
+
+            for (int b = 1; b < keep_bytes; b++)
+                full.w[l] &= ~ends[b].w[l];
+        }
+
+        for (int n = 0; n < N; n++)
+            scatter_lane(sliced_lfsr_bit(&lfsr, n), &full, &pk->state[0], TB_MAX_BEATS * fold, k * fold + fold - 1, state_words, n);
+    }
+} // build_packets
+
+static void emit_hex(emit_buf *out, const gf2_word *v, int digits)
+{
+    static const char hex[] = "0123456789abcdef";
+
+    if (out->len + digits > out->cap && !emit_reserve(out, digits))
+        return;
+
+    for (int i = digits - 1; i >= 0; i--)
+        out->data[out->len++] = hex[(v[i / 16] >> (4 * (i % 16))) & 15];
+}
+
+//
+// one clock cycle: the inputs driven before the edge and crc_out, crc_valid
+// and crc_ready after it. data NULL drives random data, keep_bytes -1 a
+// random data_keep, channel -1 a random channel_id. state is the lfsr_q the
+// cycle leads to, NULL when the core takes nothing, so crc_en can be driven
+// while a folded core is busy.
+//
+static void emit_cycle(tb_timeline *tl,
+                       bool rst,
+                       bool crc_en,
+                       bool crc_sop,
+                       int channel,
+                       const gf2_word *data,
+                       int keep_bytes,
+                       const gf2_word *state,
+                       uint64_t *seed)
+{
+    const testbench_params *p = tl->p;
+    int N = p->lfsr_poly_size;
+    int M = p->num_data_bits;
+    bool crc_valid = false;
+
+    if (rst)
+    {
+        gf2_vec_copy(&tl->lfsr_q[0], p->init, GF2_WORDS(N));
+        tl->pending.clear();
+        tl->fold_cnt = 0;
+    }
+    else
+    {
+        if (state)
+        {
+            tb_beat beat = {tl->cycle + p->latency, state, channel};
+
+            tl->pending.push_back(beat);
+        }
+
+        if (tl->fold_cnt)
+            tl->fold_cnt--;
+        else if (crc_en)
+            tl->fold_cnt = p->fold - 1;
+    }
+
+    if (!tl->pending.empty() && tl->pending.front().due == tl->cycle)
+    {
+        gf2_vec_copy(&tl->lfsr_q[0], tl->pending.front().state, GF2_WORDS(N));
+        tl->crc_channel = tl->pending.front().channel;
+        tl->pending.pop_front();
+        crc_valid = true;
+    }
+
+    if (!data)
+    {
+        for (size_t i = 0; i < tl->idle_data.size(); i++)
+            tl->idle_data[i] = splitmix64(seed);
+
+        mask_top(&tl->idle_data[0], M);
+        data = &tl->idle_data[0];
+    }
+
+    // crc_out = (OUTPUT_INV ? rev(lfsr_q) : lfsr_q) ^ OUTPUT_XOR
+    if (p->output_inv)
+    {
+        gf2_vec_zero(&tl->crc_out[0], GF2_WORDS(N));
+
+        for (int n = 0; n < N; n++)
+        {
+            if (gf2_get(&tl->lfsr_q[0], n))
+                gf2_set(&tl->crc_out[0], N - 1 - n);
+        }
+    }
+    else
+    {
+        gf2_vec_copy(&tl->crc_out[0], &tl->lfsr_q[0], GF2_WORDS(N));
+    }
+
+    gf2_vec_xor(&tl->crc_out[0], p->xorout, GF2_WORDS(N));
+
+    // a folded core has crc_ready in place of crc_valid, a multi-channel
+    // core takes crc_sop in its place
+    bool crc_ready = p->fold > 1 && !tl->fold_cnt;
+    bool flag3 = p->channels ? crc_sop : crc_ready;
+    char flags = "0123456789abcdef"[(flag3 ? 8 : 0) | (crc_valid && p->fold == 1 ? 4 : 0) | (rst ? 2 : 0) | (crc_en ? 1 : 0)];
+
+    emit_mem(tl->out, &flags, 1);
+
+    if (tl->channel_digits)
+    {
+        gf2_word id = channel < 0 ? splitmix64(seed) % ((gf2_word)1 << channel_id_bits(p->channels)) : (gf2_word)channel;
+        gf2_word crc_channel = (gf2_word)tl->crc_channel;
+
+        emit_hex(tl->out, &id, tl->channel_digits);
+        emit_hex(tl->out, &crc_channel, tl->channel_digits);
+    }
+
+    if (tl->keep_digits)
+    {
+        int bytes = M / 8;
+
+        gf2_vec_zero(&tl->keep[0], (int)tl->keep.size());
+
+        for (int b = 0; b < bytes; b++)
+        {
+            if (keep_bytes < 0 ? (splitmix64(seed) & 1) : b < keep_bytes)
+                gf2_set(&tl->keep[0], b);
+        }
+
+        emit_hex(tl->out, &tl->keep[0], tl->keep_digits);
+    }
+
+    emit_hex(tl->out, data, tl->data_digits);
+    emit_hex(tl->out, &tl->crc_out[0], tl->crc_digits);
+    EMIT_LIT(tl->out, "\n");
+
+    tl->cycle++;
+} // emit_cycle
+
+//
+// every packet starts with a reset cycle, crc_en random as the core must
+// ignore it, and ends with at least 'latency' idle cycles so its last beat
+// reaches lfsr_q before the next reset. a folded beat is followed by its
+// fold-1 busy cycles with random crc_en and data_in, which the core ignores.
+//
+static void emit_packets(tb_timeline *tl, const tb_packets *pk, uint64_t *seed)
+{
+    const testbench_params *p = tl->p;
+    int data_words = GF2_WORDS(p->num_data_bits);
+    int state_words = GF2_WORDS(p->lfsr_poly_size);
+    int full_bytes = p->num_data_bits / 8;
+    int fold = p->fold;
+
+    for (int t = 0; t < SLICE_VECTORS && tl->cycle < p->cycles; t++)
+    {
+        emit_cycle(tl, true, splitmix64(seed) & 1, false, 0, NULL, -1, NULL, seed);
+
+        for (int k = 0; k < pk->beats[t] && tl->cycle < p->cycles; k++)
+        {
+            size_t at = (size_t)t * TB_MAX_BEATS + k;
+
+            while (splitmix64(seed) % 4 == 0 && tl->cycle < p->cycles)
+                emit_cycle(tl, false, false, false, 0, NULL, -1, NULL, seed);
+
+            if (tl->cycle < p->cycles)
+                emit_cycle(tl,
+                           false,
+                           true,
+                           false,
+                           0,
+                           &pk->data[at * data_words],
+                           k == pk->beats[t] - 1 && p->byte_enables ? pk->last_bytes[t] : full_bytes,
+                           &pk->state[at * fold * state_words],
+                           seed);
+
+            for (int j = 1; j < fold && tl->cycle < p->cycles; j++)
+                emit_cycle(tl, false, splitmix64(seed) & 1, false, 0, NULL, -1, &pk->state[(at * fold + j) * state_words], seed);
+        }
+
+        for (int i = p->latency + (int)(splitmix64(seed) % 3); i > 0 && tl->cycle < p->cycles; i--)
+            emit_cycle(tl, false, false, false, 0, NULL, -1, NULL, seed);
+    }
+} // emit_packets
+
+//
+// a multi-channel core is reset once, then the packets are spread over up to
+// TB_CHANNEL_SLOTS channels at a time with a beat of a random open packet on
+// every clock. half of the beats stay on the channel of the one before, which
+// takes the state from crc_q instead of the RAM. idle cycles drive random
+// crc_sop, data_in and channel_id, also above CHANNELS, which the core must
+// ignore. the last beats land before the next packets are drawn.
+//
+static void emit_channel_packets(tb_timeline *tl, const tb_packets *pk, uint64_t *seed)
+{
+    const testbench_params *p = tl->p;
+    int data_words = GF2_WORDS(p->num_data_bits);
+    int state_words = GF2_WORDS(p->lfsr_poly_size);
+    int slots = p->channels < TB_CHANNEL_SLOTS ? p->channels : TB_CHANNEL_SLOTS;
+    int packet[TB_CHANNEL_SLOTS];
+    int beat[TB_CHANNEL_SLOTS];
+    int channel[TB_CHANNEL_SLOTS];
+    int next = 0;
+    int open = 0;
+    int last = -1;
+
+    // crc_en may read the RAM under reset, so the channel_id is a real one
+    if (tl->cycle == 0)
+        emit_cycle(tl, true, splitmix64(seed) & 1, splitmix64(seed) & 1, (int)(splitmix64(seed) % p->channels), NULL, -1, NULL, seed);
+
+    for (int s = 0; s < slots; s++)
+        packet[s] = -1;
+
+    while (tl->cycle < p->cycles)
+    {
+        for (int s = 0; s < slots && next < SLICE_VECTORS; s++)
+        {
+            if (packet[s] >= 0)
+                continue;
+
+            bool taken = true;
+
+            while (taken)
+            {
+                channel[s] = (int)(splitmix64(seed) % p->channels);
+                taken = false;
+
+                for (int o = 0; o < slots; o++)
+                    taken |= o != s && packet[o] >= 0 && channel[o] == channel[s];
+            }
+
+            packet[s] = next++;
+            beat[s] = 0;
+            open++;
+        }
+
+        if (!open)
+            break;
+
+        if (splitmix64(seed) % 4 == 0)
+        {
+            emit_cycle(tl, false, false, splitmix64(seed) & 1, -1, NULL, -1, NULL, seed);
+            continue;
+        }
+
+        int s = last;
+
+        if (s < 0 || packet[s] < 0 || (splitmix64(seed) & 1))
+        {
+            do
+                s = (int)(splitmix64(seed) % slots);
+            while (packet[s] < 0);
+        }
+
+        size_t at = (size_t)packet[s] * TB_MAX_BEATS + beat[s];
+
+        emit_cycle(tl,
+                   false,
+                   true,
+                   beat[s] == 0,
+                   channel[s],
+                   &pk->data[at * data_words],
+                   p->num_data_bits / 8,
+                   &pk->state[at * state_words],
+                   seed);
+
+        last = s;
+
+        if (++beat[s] == pk->beats[packet[s]])
+        {
+            packet[s] = -1;
+            open--;
+        }
+    }
+
+    for (int i = p->latency; i > 0 && tl->cycle < p->cycles; i--)
+        emit_cycle(tl, false, false, splitmix64(seed) & 1, -1, NULL, -1, NULL, seed);
+} // emit_channel_packets
+
+//
+// field layout of a vector line, in bits from the lsb
+//
+struct tb_layout
+{
+    int crc_lsb;
+    int data_lsb;
+    int keep_lsb;
+    int channel_lsb; // crc_channel
+    int id_lsb;      // channel_id
+    int flag_lsb;
+    int vec_bits;
+};
+
+static void tb_fields(const tb_timeline *tl, tb_layout *f)
+{
+    f->crc_lsb = 0;
+    f->data_lsb = 4 * tl->crc_digits;
+    f->keep_lsb = f->data_lsb + 4 * tl->data_digits;
+    f->channel_lsb = f->keep_lsb + 4 * tl->keep_digits;
+    f->id_lsb = f->channel_lsb + 4 * tl->channel_digits;
+    f->flag_lsb = f->id_lsb + 4 * tl->channel_digits;
+    f->vec_bits = f->flag_lsb + 4;
+}
+
+// fields of a vector line between flags and data_in
+static const char *tb_extra_fields(const testbench_params *p)
+{
+    if (p->byte_enables)
+        return "data_keep, ";
+
+    if (p->channels)
+        return "channel_id, crc_channel, ";
+
+    return "";
+}
+
+static void print_verilog_tb(emit_buf *out, const tb_timeline *tl, const char *mem_name)
+{
+    const testbench_params *p = tl->p;
+    int N = p->lfsr_poly_size;
+    int M = p->num_data_bits;
+    bool has_valid = p->latency > 0;
+    bool has_ready = p->fold > 1;
+    const char *module = p->channels ? "crc_channels" : "crc";
+    const char *flags = p->channels ? "crc_sop, crc_valid" : has_ready ? "crc_ready, 1'b0" : "1'b0, crc_valid";
+    tb_layout f;
+
+    tb_fields(tl, &f);
+
+    emit_fmt(out,
+             "//-----------------------------------------------------------------------------\n"
+             "// testbench for the %s module: data(%d:0), crc(%d:0)\n"
+             "//\n"
+             "// replays %s, one line per clock cycle: {flags, %sdata_in, crc_out}\n"
+             "// with flags = {%s, rst, crc_en}. the inputs change on the\n"
+             "// falling edge, the outputs are checked just after the rising edge.\n"
+             "// run it from the directory of %s, it ends with PASS or FAIL.\n"
+             "//-----------------------------------------------------------------------------\n"
+             "`timescale 1ns / 1ps\n"
+             "\n"
+             "module crc_tb;\n"
+             "\n"
+             "    localparam INPUT_WIDTH  = %d;\n"
+             "    localparam OUTPUT_WIDTH = %d;\n"
+             "    localparam NUM_VECTORS  = %lld;\n"
+             "    localparam VEC_BITS     = %d;\n"
+             "    localparam CRC_LSB      = %d;\n"
+             "    localparam DATA_LSB     = %d;\n",
+             module,
+             M - 1,
+             N - 1,
+             mem_name,
+             tb_extra_fields(p),
+             flags,
+             mem_name,
+             M,
+             N,
+             tl->cycle,
+             f.vec_bits,
+             f.crc_lsb,
+             f.data_lsb);
+
+    if (p->byte_enables)
+        emit_fmt(out, "    localparam KEEP_LSB     = %d;\n", f.keep_lsb);
+
+    if (p->channels)
+        emit_fmt(out,
+                 "    localparam CHANNEL_BITS = %d;\n"
+                 "    localparam CHANNEL_LSB  = %d;\n"
+                 "    localparam ID_LSB       = %d;\n",
+                 channel_id_bits(p->channels),
+                 f.channel_lsb,
+                 f.id_lsb);
+
+    emit_fmt(out,
+             "    localparam FLAG_LSB     = %d;\n"
+             "\n"
+             "    reg                        clk = 1'b0;\n"
+             "    reg                        rst = 1'b1;\n"
+             "    reg                        crc_en = 1'b0;\n"
+             "    reg  [ (INPUT_WIDTH-1):0]  data_in = {INPUT_WIDTH{1'b0}};\n",
+             f.flag_lsb);
+
+    if (p->byte_enables)
+        EMIT_LIT(out, "    reg  [(INPUT_WIDTH/8-1):0] data_keep = {(INPUT_WIDTH/8){1'b1}};\n");
+
+    if (p->channels)
+        EMIT_LIT(out,
+                 "    reg                        crc_sop = 1'b0;\n"
+                 "    reg  [(CHANNEL_BITS-1):0]  channel_id = {CHANNEL_BITS{1'b0}};\n");
+
+    EMIT_LIT(out, "    wire [(OUTPUT_WIDTH-1):0]  crc_out;\n");
+
+    if (has_valid)
+        EMIT_LIT(out, "    wire                       crc_valid;\n");
+
+    if (p->channels)
+        EMIT_LIT(out, "    wire [(CHANNEL_BITS-1):0]  crc_channel;\n");
+
+    if (has_ready)
+        EMIT_LIT(out, "    wire                       crc_ready;\n");
+
+    EMIT_LIT(out,
+             "\n"
+             "    reg  [(VEC_BITS-1):0] vectors [0:(NUM_VECTORS-1)];\n"
+             "    reg  [(VEC_BITS-1):0] vec;\n"
+             "    integer i;\n"
+             "    integer errors;\n"
+             "\n");
+
+    emit_fmt(out, "    %s #(\n", module);
+
+    emit_fmt(out, "        .INIT       (%d'h", N);
+    emit_hex(out, p->init, (N + 3) / 4);
+    emit_fmt(out, "),\n        .OUTPUT_XOR (%d'h", N);
+    emit_hex(out, p->xorout, (N + 3) / 4);
+    emit_fmt(out,
+             "),\n"
+             "        .INPUT_INV  (1'b%d),\n"
+             "        .OUTPUT_INV (1'b%d)\n"
+             "    ) dut (\n"
+             "        .data_in   (data_in),\n"
+             "        .crc_en    (crc_en),\n",
+             p->input_inv ? 1 : 0,
+             p->output_inv ? 1 : 0);
+
+    if (p->byte_enables)
+        EMIT_LIT(out, "        .data_keep (data_keep),\n");
+
+    if (p->channels)
+        EMIT_LIT(out,
+                 "        .crc_sop   (crc_sop),\n"
+                 "        .channel_id (channel_id),\n");
+
+    EMIT_LIT(out, "        .crc_out   (crc_out),\n");
+
+    if (has_valid)
+        EMIT_LIT(out, "        .crc_valid (crc_valid),\n");
+
+    if (p->channels)
+        EMIT_LIT(out, "        .crc_channel (crc_channel),\n");
+
+    if (has_ready)
+        EMIT_LIT(out, "        .crc_ready (crc_ready),\n");
+
+    emit_fmt(out,
+             "        .rst       (rst),\n"
+             "        .clk       (clk)\n"
+             "    );\n"
+             "\n"
+             "    always #5 clk = ~clk;\n"
+             "\n"
+             "    initial begin\n"
+             "        errors = 0;\n"
+             "        $readmemh(\"%s\", vectors);\n"
+             "\n"
+             "        for (i = 0; i < NUM_VECTORS; i = i + 1) begin\n"
+             "            vec = vectors[i];\n"
+             "\n"
+             "            @(negedge clk);\n"
+             "            rst       <= vec[FLAG_LSB+1];\n"
+             "            crc_en    <= vec[FLAG_LSB];\n"
+             "            data_in   <= vec[DATA_LSB +: INPUT_WIDTH];\n",
+             mem_name);
+
+    if (p->byte_enables)
+        EMIT_LIT(out, "            data_keep <= vec[KEEP_LSB +: (INPUT_WIDTH/8)];\n");
+
+    if (p->channels)
+        EMIT_LIT(out,
+                 "            crc_sop   <= vec[FLAG_LSB+3];\n"
+                 "            channel_id <= vec[ID_LSB +: CHANNEL_BITS];\n");
+
+    EMIT_LIT(out,
+             "\n"
+             "            @(posedge clk);\n"
+             "            #1;\n");
+
+    // crc_out and crc_channel only hold a beat with crc_valid
+    if (p->channels)
+        EMIT_LIT(out,
+                 "            if (crc_valid !== vec[FLAG_LSB+2] ||\n"
+                 "                (vec[FLAG_LSB+2] && (crc_out !== vec[CRC_LSB +: OUTPUT_WIDTH] || crc_channel !== vec[CHANNEL_LSB +: CHANNEL_BITS]))) begin\n"
+                 "                if (errors < 10)\n"
+                 "                    $display(\"cycle %0d: crc_valid %b crc_channel %0d crc_out %h, expected %b %0d %h\",\n"
+                 "                             i, crc_valid, crc_channel, crc_out,\n"
+                 "                             vec[FLAG_LSB+2], vec[CHANNEL_LSB +: CHANNEL_BITS], vec[CRC_LSB +: OUTPUT_WIDTH]);\n");
+    else if (has_valid)
+        EMIT_LIT(out,
+                 "            if (crc_out !== vec[CRC_LSB +: OUTPUT_WIDTH] || crc_valid !== vec[FLAG_LSB+2]) begin\n"
+                 "                if (errors < 10)\n"
+                 "                    $display(\"cycle %0d: crc_out %h crc_valid %b, expected %h %b\",\n"
+                 "                             i, crc_out, crc_valid, vec[CRC_LSB +: OUTPUT_WIDTH], vec[FLAG_LSB+2]);\n");
+    else if (has_ready)
+        EMIT_LIT(out,
+                 "            if (crc_out !== vec[CRC_LSB +: OUTPUT_WIDTH] || crc_ready !== vec[FLAG_LSB+3]) begin\n"
+                 "                if (errors < 10)\n"
+                 "                    $display(\"cycle %0d: crc_out %h crc_ready %b, expected %h %b\",\n"
+                 "                             i, crc_out, crc_ready, vec[CRC_LSB +: OUTPUT_WIDTH], vec[FLAG_LSB+3]);\n");
+    else
+        EMIT_LIT(out,
+                 "            if (crc_out !== vec[CRC_LSB +: OUTPUT_WIDTH]) begin\n"
+                 "                if (errors < 10)\n"
+                 "                    $display(\"cycle %0d: crc_out %h, expected %h\", i, crc_out, vec[CRC_LSB +: OUTPUT_WIDTH]);\n");
+
+    EMIT_LIT(out,
+             "                errors = errors + 1;\n"
+             "            end\n"
+             "        end\n"
+             "\n"
+             "        if (errors == 0)\n"
+             "            $display(\"PASS: %0d cycles\", NUM_VECTORS);\n"
+             "        else\n"
+             "            $display(\"FAIL: %0d of %0d cycles differ\", errors, NUM_VECTORS);\n"
+             "        $finish;\n"
+             "    end\n"
+             "endmodule // crc_tb\n");
+} // print_verilog_tb
+
+static void print_vhdl_tb(emit_buf *out, const tb_timeline *tl, const char *mem_name)
+{
+    const testbench_params *p = tl->p;
+    int N = p->lfsr_poly_size;
+    int M = p->num_data_bits;
+    bool has_valid = p->latency > 0;
+    bool has_ready = p->fold > 1;
+    const char *entity = p->channels ? "crc_channels" : "crc";
+    const char *flags = p->channels ? "crc_sop, crc_valid" : has_ready ? "crc_ready, '0'" : "'0', crc_valid";
+    tb_layout f;
+
+    tb_fields(tl, &f);
+
+    emit_fmt(out,
+             "-------------------------------------------------------------------------------\n"
+             "-- testbench for the %s entity: data(%d:0), crc(%d:0)\n"
+             "--\n"
+             "-- replays %s, one line per clock cycle: {flags, %sdata_in, crc_out}\n"
+             "-- with flags = {%s, rst, crc_en}. the inputs change on the\n"
+             "-- falling edge, the outputs are checked just after the rising edge.\n"
+             "-- VHDL-2008 (hread, to_hstring). run it from the directory of %s,\n"
+             "-- it ends with PASS or FAIL.\n"
+             "-------------------------------------------------------------------------------\n"
+             "library ieee;\n"
+             "use ieee.std_logic_1164.all;\n"
+             "use std.textio.all;\n"
+             "\n"
+             "entity crc_tb is\n"
+             "end entity crc_tb;\n"
+             "\n"
+             "architecture sim of crc_tb is\n"
+             "    constant INPUT_WIDTH  : integer := %d;\n"
+             "    constant OUTPUT_WIDTH : integer := %d;\n"
+             "    constant VEC_BITS     : integer := %d;\n"
+             "    constant CRC_LSB      : integer := %d;\n"
+             "    constant DATA_LSB     : integer := %d;\n",
+             entity,
+             M - 1,
+             N - 1,
+             mem_name,
+             tb_extra_fields(p),
+             flags,
+             mem_name,
+             M,
+             N,
+             f.vec_bits,
+             f.crc_lsb,
+             f.data_lsb);
+
+    if (p->byte_enables)
+        emit_fmt(out, "    constant KEEP_LSB     : integer := %d;\n", f.keep_lsb);
+
+    if (p->channels)
+        emit_fmt(out,
+                 "    constant CHANNEL_BITS : integer := %d;\n"
+                 "    constant CHANNEL_LSB  : integer := %d;\n"
+                 "    constant ID_LSB       : integer := %d;\n",
+                 channel_id_bits(p->channels),
+                 f.channel_lsb,
+                 f.id_lsb);
+
+    emit_fmt(out,
+             "    constant FLAG_LSB     : integer := %d;\n"
+             "\n"
+             "    signal clk       : std_logic := '0';\n"
+             "    signal rst       : std_logic := '1';\n"
+             "    signal crc_en    : std_logic := '0';\n"
+             "    signal data_in   : std_logic_vector((INPUT_WIDTH-1) downto 0) := (others => '0');\n",
+             f.flag_lsb);
+
+    if (p->byte_enables)
+        EMIT_LIT(out, "    signal data_keep : std_logic_vector((INPUT_WIDTH/8-1) downto 0) := (others => '1');\n");
+
+    if (p->channels)
+        EMIT_LIT(out,
+                 "    signal crc_sop   : std_logic := '0';\n"
+                 "    signal channel_id : std_logic_vector((CHANNEL_BITS-1) downto 0) := (others => '0');\n");
+
+    EMIT_LIT(out, "    signal crc_out   : std_logic_vector((OUTPUT_WIDTH-1) downto 0);\n");
+
+    if (has_valid)
+        EMIT_LIT(out, "    signal crc_valid : std_logic;\n");
+
+    if (p->channels)
+        EMIT_LIT(out, "    signal crc_channel : std_logic_vector((CHANNEL_BITS-1) downto 0);\n");
+
+    if (has_ready)
+        EMIT_LIT(out, "    signal crc_ready : std_logic;\n");
+
+    emit_fmt(out,
+             "    signal done      : boolean := false;\n"
+             "begin\n"
+             "\n"
+             "    dut: entity work.%s\n"
+             "        generic map (\n"
+             "            INIT       => %dx\"",
+             entity,
+             N);
+    emit_hex(out, p->init, (N + 3) / 4);
+    emit_fmt(out, "\",\n            OUTPUT_XOR => %dx\"", N);
+    emit_hex(out, p->xorout, (N + 3) / 4);
+    emit_fmt(out,
+             "\",\n"
+             "            INPUT_INV  => '%d',\n"
+             "            OUTPUT_INV => '%d'\n"
+             "        )\n"
+             "        port map (\n"
+             "            data_in   => data_in,\n"
+             "            crc_en    => crc_en,\n",
+             p->input_inv ? 1 : 0,
+             p->output_inv ? 1 : 0);
+
+    if (p->byte_enables)
+        EMIT_LIT(out, "            data_keep => data_keep,\n");
+
+    if (p->channels)
+        EMIT_LIT(out,
+                 "            crc_sop   => crc_sop,\n"
+                 "            channel_id => channel_id,\n");
+
+    EMIT_LIT(out, "            crc_out   => crc_out,\n");
+
+    if (has_valid)
+        EMIT_LIT(out, "            crc_valid => crc_valid,\n");
+
+    if (p->channels)
+        EMIT_LIT(out, "            crc_channel => crc_channel,\n");
+
+    if (has_ready)
+        EMIT_LIT(out, "            crc_ready => crc_ready,\n");
+
+    emit_fmt(out,
+             "            rst       => rst,\n"
+             "            clk       => clk\n"
+             "        );\n"
+             "\n"
+             "    clk <= not clk after 5 ns when not done else clk;\n"
+             "\n"
+             "    process\n"
+             "        file vec_file   : text open read_mode is \"%s\";\n"
+             "        variable l      : line;\n"
+             "        variable vec    : std_logic_vector((VEC_BITS-1) downto 0);\n"
+             "        variable cycle  : integer := 0;\n"
+             "        variable errors : integer := 0;\n"
+             "    begin\n"
+             "        while not endfile(vec_file) loop\n"
+             "            readline(vec_file, l);\n"
+             "            hread(l, vec);\n"
+             "\n"
+             "            wait until falling_edge(clk);\n"
+             "            rst       <= vec(FLAG_LSB+1);\n"
+             "            crc_en    <= vec(FLAG_LSB);\n"
+             "            data_in   <= vec((DATA_LSB+INPUT_WIDTH-1) downto DATA_LSB);\n",
+             mem_name);
+
+    if (p->byte_enables)
+        EMIT_LIT(out, "            data_keep <= vec((KEEP_LSB+INPUT_WIDTH/8-1) downto KEEP_LSB);\n");
+
+    if (p->channels)
+        EMIT_LIT(out,
+                 "            crc_sop   <= vec(FLAG_LSB+3);\n"
+                 "            channel_id <= vec((ID_LSB+CHANNEL_BITS-1) downto ID_LSB);\n");
+
+    EMIT_LIT(out,
+             "\n"
+             "            wait until rising_edge(clk);\n"
+             "            wait for 1 ns;\n");
+
+    // crc_out and crc_channel only hold a beat with crc_valid
+    if (p->channels)
+        EMIT_LIT(out,
+                 "            if crc_valid /= vec(FLAG_LSB+2) or\n"
+                 "               (vec(FLAG_LSB+2) = '1' and (crc_out /= vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB) or\n"
+                 "                                          crc_channel /= vec((CHANNEL_LSB+CHANNEL_BITS-1) downto CHANNEL_LSB))) then\n"
+                 "                if errors < 10 then\n"
+                 "                    report \"cycle \" & integer'image(cycle) & \": crc_valid \" & std_logic'image(crc_valid) &\n"
+                 "                           \" crc_channel \" & to_hstring(crc_channel) & \" crc_out \" & to_hstring(crc_out) &\n"
+                 "                           \", expected \" & std_logic'image(vec(FLAG_LSB+2)) &\n"
+                 "                           \" \" & to_hstring(vec((CHANNEL_LSB+CHANNEL_BITS-1) downto CHANNEL_LSB)) &\n"
+                 "                           \" \" & to_hstring(vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB)) severity error;\n");
+    else if (has_valid)
+        EMIT_LIT(out,
+                 "            if crc_out /= vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB) or crc_valid /= vec(FLAG_LSB+2) then\n"
+                 "                if errors < 10 then\n"
+                 "                    report \"cycle \" & integer'image(cycle) & \": crc_out \" & to_hstring(crc_out) &\n"
+                 "                           \" crc_valid \" & std_logic'image(crc_valid) &\n"
+                 "                           \", expected \" & to_hstring(vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB)) &\n"
+                 "                           \" \" & std_logic'image(vec(FLAG_LSB+2)) severity error;\n");
+    else if (has_ready)
+        EMIT_LIT(out,
+                 "            if crc_out /= vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB) or crc_ready /= vec(FLAG_LSB+3) then\n"
+                 "                if errors < 10 then\n"
+                 "                    report \"cycle \" & integer'image(cycle) & \": crc_out \" & to_hstring(crc_out) &\n"
+                 "                           \" crc_ready \" & std_logic'image(crc_ready) &\n"
+                 "                           \", expected \" & to_hstring(vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB)) &\n"
+                 "                           \" \" & std_logic'image(vec(FLAG_LSB+3)) severity error;\n");
+    else
+        EMIT_LIT(out,
+                 "            if crc_out /= vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB) then\n"
+                 "                if errors < 10 then\n"
+                 "                    report \"cycle \" & integer'image(cycle) & \": crc_out \" & to_hstring(crc_out) &\n"
+                 "                           \", expected \" & to_hstring(vec((CRC_LSB+OUTPUT_WIDTH-1) downto CRC_LSB)) severity error;\n");
+
+    EMIT_LIT(out,
+             "                end if;\n"
+             "                errors := errors + 1;\n"
+             "            end if;\n"
+             "            cycle := cycle + 1;\n"
+             "        end loop;\n"
+             "\n"
+             "        if errors = 0 then\n"
+             "            report \"PASS: \" & integer'image(cycle) & \" cycles\";\n"
+             "        else\n"
+             "            report \"FAIL: \" & integer'image(errors) & \" of \" & integer'image(cycle) & \" cycles differ\" severity error;\n"
+             "        end if;\n"
+             "        done <= true;\n"
+             "        wait;\n"
+             "    end process;\n"
+             "\n"
+             "end architecture sim;\n");
+} // print_vhdl_tb
+
+bool write_testbench(const char *name,
+                     const testbench_params *p,
+                     const char *tb_path,
+                     const char *mem_path,
+                     const char *mem_name)
+{
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    int N = p->lfsr_poly_size;
+    int M = p->num_data_bits;
+    emit_buf mem;
+    tb_timeline tl;
+
+    tl.p = p;
+    tl.out = &mem;
+    tl.cycle = 0;
+    tl.crc_digits = (N + 3) / 4;
+    tl.data_digits = (M + 3) / 4;
+    tl.keep_digits = p->byte_enables ? (M / 8 + 3) / 4 : 0;
+    tl.channel_digits = p->channels ? (channel_id_bits(p->channels) + 3) / 4 : 0;
+    tl.fold_cnt = 0;
+    tl.crc_channel = 0;
+    tl.lfsr_q.assign(GF2_WORDS(N), 0);
+    tl.crc_out.assign(GF2_WORDS(N), 0);
+    tl.idle_data.assign(GF2_WORDS(M), 0);
+    tl.keep.assign(GF2_WORDS(M / 8 + 1), 0);
+
+    if (!emit_open(&mem, mem_path, (size_t)1 << 20))
+    {
+        fprintf(stderr, "\n\terror: cannot open output file %s\n", mem_path);
+        return false;
+    }
+
+    tb_packets pk;
+    uint64_t seed = 0x13198a2e03707344ull;
+
+    while (tl.cycle < p->cycles)
+    {
+        build_packets(p, &pk, &seed);
+
+        if (p->channels)
+            emit_channel_packets(&tl, &pk, &seed);
+        else
+            emit_packets(&tl, &pk, &seed);
+    }
+
+    if (!emit_close(&mem))
+    {
+        fprintf(stderr, "\n\terror: failed to write output %s\n", mem_path);
+        return false;
+    }
+
+    emit_buf out;
+
+    if (!emit_open(&out, tb_path, 0))
+    {
+        fprintf(stderr, "\n\terror: cannot open output file %s\n", tb_path);
+        return false;
+    }
+
+    if (p->is_vhdl)
+        print_vhdl_tb(&out, &tl, mem_name);
+    else
+        print_verilog_tb(&out, &tl, mem_name);
+
+    if (!emit_close(&out))
+    {
+        fprintf(stderr, "\n\terror: failed to write output %s\n", tb_path);
+        return false;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    fprintf(stderr, "%s: testbench %s, %lld cycles in %s (%.2f s)\n", name, tb_path, tl.cycle, mem_path, elapsed);
+
+    return true;
+} // write_testbench
@@ -0,0 +1,84 @@
+/*
+The MIT License
+
+Copyright (c) 2024 John_Tito
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated
+documentation files (the "Software"), to deal in the
+Software without restriction, including without limitation
+the rights to use, copy, modify, merge, publish, distribute,
+sublicense, and/or sell copies of the Software, and to
+permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall
+be included in all copies or substantial portions of the
+Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS
+OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT
+OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TESTBENCH_H
+#define TESTBENCH_H
+
+#include "gf2.h"
+
+//
+// self-checking testbench for a generated crc module
+//
+// the testbench replays a vector file with one line per clock cycle: random
+// packets of 1..TB_MAX_BEATS beats, each after a reset cycle, with random
+// crc_en gaps between the beats, and the crc_out expected after every clock
+// edge. a folded beat is followed by fold-1 clocks of random crc_en that the
+// core must ignore, and crc_out is checked after each of its slices. on a
+// multi-channel core a few packets at a time are interleaved on their own
+// channels, and crc_out and crc_channel are checked with crc_valid. the
+// expected values are computed here with the bit-sliced serial LFSR of
+// bitslice.h, SLICE_VECTORS packets at a time, not from the equations under
+// test.
+//
+// a line is the hex of {flags, [data_keep,] [channel_id, crc_channel,]
+// data_in, crc_out} with every field padded to whole hex digits, flags =
+// {crc_ready, crc_valid, rst, crc_en}. bit 3 is crc_ready for a folded core,
+// the crc_sop input for a multi-channel one and 0 otherwise. it is read with
+// $readmemh in verilog and the VHDL-2008 textio hread.
+//
+#define TB_MAX_BEATS 16
+
+struct testbench_params
+{
+    bool is_vhdl;
+    int lfsr_poly_size;
+    int num_data_bits;
+    const gf2_word *lfsr_poly;
+
+    // generics of the instance, lfsr_poly_size bits each
+    const gf2_word *init;
+    const gf2_word *xorout;
+    bool input_inv;
+    bool output_inv;
+
+    int latency;       // --pipeline stages, crc_valid is checked when set
+    bool byte_enables; // the last beat of a packet may be partial
+    int fold;          // clocks per beat, crc_ready is checked above 1
+    int channels;      // crc_channels core of this many channels, 0 for crc
+    long long cycles;
+};
+
+// write the testbench to tb_path and the vectors to mem_path, which the
+// testbench opens as mem_name. returns false if a file could not be written.
+bool write_testbench(const char *name,
+                     const testbench_params *p,
+                     const char *tb_path,
+                     const char *mem_path,
+                     const char *mem_name);
+
+#endif // TESTBENCH_H